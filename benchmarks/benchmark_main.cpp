@@ -1,9 +1,11 @@
 #include <chrono>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <iomanip>
 
 #include "arena_allocator.h"
+#include "benchmark_utils.h"
 
 struct Particle {
     float x, y, z;
@@ -27,6 +29,7 @@ int main() {
     constexpr int TEST_REPEATS = 5;
 
     std::cout << "--- BENCHMARK STARTING ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
     std::cout << "Object Count: " << ITERATIONS << "\n";
     std::cout << "Object Size : " << sizeof(Particle) << " bytes\n\n";
 
@@ -0,0 +1,212 @@
+#pragma once
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define BENCHMARK_HAS_MALLINFO2 1
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Set by benchmarks/CMakeLists.txt for the copies linked against jemalloc, mimalloc, tcmalloc,
+// together with BENCHMARK_ALLOCATOR_JEMALLOC / _MIMALLOC / _TCMALLOC.
+#ifndef BENCHMARK_ALLOCATOR_NAME
+#define BENCHMARK_ALLOCATOR_NAME "system malloc"
+#endif
+
+// Stats entry points of the linked allocator, declared here so only its library is needed.
+#if defined(BENCHMARK_ALLOCATOR_JEMALLOC)
+extern "C" int mallctl(const char* name, void* oldValue, size_t* oldLength, void* newValue,
+                       size_t newLength);
+#elif defined(BENCHMARK_ALLOCATOR_MIMALLOC)
+extern "C" void mi_process_info(size_t* elapsedMs, size_t* userMs, size_t* systemMs,
+                                size_t* currentRss, size_t* peakRss, size_t* currentCommit,
+                                size_t* peakCommit, size_t* pageFaults);
+#elif defined(BENCHMARK_ALLOCATOR_TCMALLOC)
+extern "C" int MallocExtension_GetNumericProperty(const char* property, size_t* value);
+#endif
+
+/** @brief The malloc behind new/delete and std containers in this benchmark binary */
+inline constexpr const char* kHeapAllocatorName = BENCHMARK_ALLOCATOR_NAME;
+
+/** @brief Runs func once and returns the elapsed wall time in milliseconds */
+template <typename Func>
+double MeasureMs(Func func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/** @brief Average of repeats runs of func in milliseconds */
+template <typename Func>
+double AverageMs(const int repeats, Func func) {
+    double total = 0.0;
+    for (int i = 0; i < repeats; ++i) {
+        total += MeasureMs(func);
+    }
+    return total / repeats;
+}
+
+/**
+ * @brief Reads a "<field> <value> kB" line from /proc/self/status, e.g. "VmHWM:"
+ * @return The value in kB, or -1 where /proc is not available
+ */
+inline long ReadProcStatusKb(const char* field) {
+    FILE* status = std::fopen("/proc/self/status", "r");
+    if (!status) return -1;
+
+    char line[256];
+    long value = -1;
+    const size_t fieldLength = std::strlen(field);
+    while (std::fgets(line, sizeof(line), status)) {
+        if (std::strncmp(line, field, fieldLength) == 0) {
+            value = std::strtol(line + fieldLength, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(status);
+    return value;
+}
+
+/**
+ * @brief Lowers the peak-RSS mark (VmHWM) to the current RSS; later reads cover what follows
+ * @return false if the kernel (or sandbox) did not allow the reset
+ */
+inline bool ResetPeakRss() {
+    FILE* clearRefs = std::fopen("/proc/self/clear_refs", "w");
+    if (!clearRefs) return false;
+    std::fputs("5", clearRefs);
+    std::fclose(clearRefs);
+    return ReadProcStatusKb("VmHWM:") <= ReadProcStatusKb("VmRSS:");
+}
+
+/** @brief Peak resident set size in kB since start or the last ResetPeakRss(); -1 if unknown */
+inline long PeakRssKb() { return ReadProcStatusKb("VmHWM:"); }
+
+struct PageFaultCounts {
+    long minor = -1; // Served without I/O, e.g. first touch of a fresh page
+    long major = -1; // Needed I/O
+};
+
+/** @brief Page faults of this process so far (getrusage); -1 where unsupported */
+inline PageFaultCounts ReadPageFaults() {
+    PageFaultCounts counts;
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        counts.minor = usage.ru_minflt;
+        counts.major = usage.ru_majflt;
+    }
+#endif
+    return counts;
+}
+
+/**
+ * @brief Bytes the heap allocator of this binary currently holds from the OS; -1 if unknown
+ *
+ * Asks the allocator the binary was linked with (jemalloc "stats.mapped", mimalloc's
+ * committed bytes, tcmalloc's heap size minus unmapped pages), and glibc mallinfo2() only for
+ * the system malloc: in the other variants glibc's own arena is idle and says nothing.
+ */
+inline long long MallocSystemBytes() {
+#if defined(BENCHMARK_ALLOCATOR_JEMALLOC)
+    uint64_t epoch = 1; // Stats are snapshots; bumping the epoch refreshes them
+    size_t length = sizeof(epoch);
+    mallctl("epoch", &epoch, &length, &epoch, length);
+    size_t mapped = 0;
+    length = sizeof(mapped);
+    if (mallctl("stats.mapped", &mapped, &length, nullptr, 0) != 0) return -1;
+    return static_cast<long long>(mapped);
+#elif defined(BENCHMARK_ALLOCATOR_MIMALLOC)
+    size_t elapsed, user, system, rss, peakRss, commit = 0, peakCommit, faults;
+    mi_process_info(&elapsed, &user, &system, &rss, &peakRss, &commit, &peakCommit, &faults);
+    return static_cast<long long>(commit);
+#elif defined(BENCHMARK_ALLOCATOR_TCMALLOC)
+    size_t heap = 0;
+    size_t unmapped = 0;
+    if (!MallocExtension_GetNumericProperty("generic.heap_size", &heap) ||
+        !MallocExtension_GetNumericProperty("tcmalloc.pageheap_unmapped_bytes", &unmapped)) {
+        return -1;
+    }
+    return static_cast<long long>(heap - unmapped);
+#elif defined(BENCHMARK_HAS_MALLINFO2)
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast<long long>(info.arena + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief Counts last-level cache misses of this thread through perf_event_open()
+ *
+ * Containers and CI machines often forbid perf events; Stop() then returns -1 and results
+ * should be shown as unavailable rather than as zero.
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (m_fd >= 0) close(m_fd);
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    void Start() {
+#if defined(__linux__)
+        if (m_fd < 0) return;
+        ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    /** @return Misses since Start(), or -1 if the counter is unavailable */
+    long long Stop() {
+#if defined(__linux__)
+        if (m_fd < 0) return -1;
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(m_fd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return static_cast<long long>(count);
+#else
+        return -1;
+#endif
+    }
+
+private:
+    int m_fd = -1;
+};
+
+#endif //BENCHMARK_UTILS_H
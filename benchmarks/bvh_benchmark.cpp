@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "arena_bvh.h"
+#include "benchmark_utils.h"
+
+// Random small boxes scattered in a cube, like a broadphase full of debris.
+std::vector<Aabb> GenerateBoxes(const uint32_t count, const uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(0.0f, 1000.0f);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+    std::vector<Aabb> boxes(count);
+    for (Aabb& box : boxes) {
+        for (int axis = 0; axis < 3; ++axis) {
+            box.min[axis] = position(rng);
+            box.max[axis] = box.min[axis] + size(rng);
+        }
+    }
+    return boxes;
+}
+
+int main() {
+    constexpr uint32_t BOX_COUNT = 200'000;
+    constexpr uint32_t QUERY_COUNT = 2'000;
+    constexpr int TEST_REPEATS = 5;
+
+    const std::vector<Aabb> boxes = GenerateBoxes(BOX_COUNT, 42);
+    const std::vector<Aabb> queries = GenerateBoxes(QUERY_COUNT, 7);
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Nodes (2N - 1) + indices + centroids, with slack for alignment and bin scratch.
+    ArenaAllocator frameArena(static_cast<size_t>(BOX_COUNT) * (2 * sizeof(BvhNode) + 20) + 65536);
+
+    std::cout << "--- BVH BENCHMARK ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
+    std::cout << "Boxes: " << BOX_COUNT << ", Queries: " << QUERY_COUNT << ", Threads: " << threads
+              << "\n\n";
+
+    Bvh bvh;
+    const double serialBuild = AverageMs(TEST_REPEATS, [&] {
+        frameArena.Reset();
+        bvh = BvhBuilder::Build(frameArena, boxes.data(), BOX_COUNT);
+    });
+
+    BvhBuildOptions parallel;
+    parallel.threadCount = threads;
+    const double parallelBuild = AverageMs(TEST_REPEATS, [&] {
+        frameArena.Reset();
+        bvh = BvhBuilder::Build(frameArena, boxes.data(), BOX_COUNT, parallel);
+    });
+
+    uint64_t bvhHits = 0;
+    const double bvhQuery = AverageMs(TEST_REPEATS, [&] {
+        bvhHits = 0;
+        for (const Aabb& query : queries) {
+            bvh.ForEachOverlap(query, boxes.data(), [&](uint32_t) { ++bvhHits; });
+        }
+    });
+
+    // Brute force on a slice of the queries only; it is orders of magnitude slower.
+    constexpr uint32_t BRUTE_QUERIES = 50;
+    uint64_t bruteHits = 0;
+    uint64_t sliceHits = 0;
+    const double bruteQuery = MeasureMs([&] {
+        for (uint32_t q = 0; q < BRUTE_QUERIES; ++q) {
+            for (const Aabb& box : boxes) bruteHits += box.Overlaps(queries[q]) ? 1 : 0;
+        }
+    });
+    for (uint32_t q = 0; q < BRUTE_QUERIES; ++q) {
+        bvh.ForEachOverlap(queries[q], boxes.data(), [&](uint32_t) { ++sliceHits; });
+    }
+
+    if (bruteHits != sliceHits) {
+        std::cerr << "Overlap mismatch: " << bruteHits << " vs " << sliceHits << "\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Build (1 thread)  : " << serialBuild << " ms, " << bvh.nodeCount << " nodes\n";
+    std::cout << "Build (" << threads << " threads) : " << parallelBuild << " ms\n";
+    std::cout << "BVH queries       : " << bvhQuery << " ms (" << bvhHits << " hits)\n";
+    std::cout << "Brute-force query : " << bruteQuery / BRUTE_QUERIES << " ms each vs "
+              << bvhQuery / QUERY_COUNT << " ms each with BVH\n";
+    std::cout << "Frame arena used  : " << frameArena.GetUsedMemory() << " bytes\n";
+
+    return 0;
+}
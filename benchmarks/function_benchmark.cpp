@@ -0,0 +1,101 @@
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <version>
+#include <vector>
+
+#include "arena_function.h"
+#include "benchmark_utils.h"
+
+// A job closure with more state than any small-buffer optimization holds (128 bytes).
+struct JobState {
+    std::array<uint64_t, 16> data;
+};
+
+JobState MakeState(const uint64_t seed) {
+    JobState state{};
+    for (size_t i = 0; i < state.data.size(); ++i) state.data[i] = seed * 31 + i;
+    return state;
+}
+
+// Builds JOB_COUNT closures into Queue, runs them all, then tears the queue down: one "frame".
+template <typename Queue, typename Emplace>
+uint64_t RunFrame(Queue& queue, const uint32_t jobCount, Emplace emplace) {
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        emplace(queue, [state = MakeState(i)](const uint64_t bias) {
+            uint64_t total = bias;
+            for (const uint64_t value : state.data) total += value;
+            return total;
+        });
+    }
+
+    uint64_t checksum = 0;
+    for (auto& job : queue) checksum += job(1);
+    queue.clear();
+    return checksum;
+}
+
+int main() {
+    constexpr uint32_t JOB_COUNT = 100'000;
+    constexpr int TEST_REPEATS = 10;
+
+    std::cout << "--- JOB CLOSURE BENCHMARK ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
+    std::cout << "Jobs per frame: " << JOB_COUNT << ", Capture size: " << sizeof(JobState)
+              << " bytes\n\n";
+
+    uint64_t stdChecksum = 0;
+    std::vector<std::function<uint64_t(uint64_t)>> stdQueue;
+    stdQueue.reserve(JOB_COUNT);
+    const double stdTime = AverageMs(TEST_REPEATS, [&] {
+        stdChecksum = RunFrame(stdQueue, JOB_COUNT, [](auto& queue, auto&& job) {
+            queue.emplace_back(std::move(job));
+        });
+    });
+
+#if defined(__cpp_lib_move_only_function)
+    uint64_t moveOnlyChecksum = 0;
+    std::vector<std::move_only_function<uint64_t(uint64_t)>> moveOnlyQueue;
+    moveOnlyQueue.reserve(JOB_COUNT);
+    const double moveOnlyTime = AverageMs(TEST_REPEATS, [&] {
+        moveOnlyChecksum = RunFrame(moveOnlyQueue, JOB_COUNT, [](auto& queue, auto&& job) {
+            queue.emplace_back(std::move(job));
+        });
+    });
+#endif
+
+    // Closures plus alignment slack; the frame reset below is the whole teardown.
+    ArenaAllocator frameArena(static_cast<size_t>(JOB_COUNT) * (sizeof(JobState) + 16) + 4096);
+    uint64_t arenaChecksum = 0;
+    std::vector<ArenaFunction<uint64_t(uint64_t)>> arenaQueue;
+    arenaQueue.reserve(JOB_COUNT);
+    const double arenaTime = AverageMs(TEST_REPEATS, [&] {
+        frameArena.Reset();
+        arenaChecksum = RunFrame(arenaQueue, JOB_COUNT, [&](auto& queue, auto&& job) {
+            queue.emplace_back(frameArena, std::move(job));
+        });
+    });
+
+    if (stdChecksum != arenaChecksum) {
+        std::cerr << "Checksum mismatch: " << stdChecksum << " vs " << arenaChecksum << "\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "std::function           : " << stdTime << " ms\n";
+#if defined(__cpp_lib_move_only_function)
+    if (moveOnlyChecksum != arenaChecksum) {
+        std::cerr << "Checksum mismatch: " << moveOnlyChecksum << " vs " << arenaChecksum << "\n";
+        return 1;
+    }
+    std::cout << "std::move_only_function : " << moveOnlyTime << " ms\n";
+#else
+    std::cout << "std::move_only_function : (not available in this standard library)\n";
+#endif
+    std::cout << "ArenaFunction           : " << arenaTime << " ms\n";
+    std::cout << "Speedup vs std::function: " << stdTime / arenaTime << "x\n";
+
+    return 0;
+}
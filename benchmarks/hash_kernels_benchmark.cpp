@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arena_hash_kernels.h"
+#include "benchmark_utils.h"
+
+// Fact/dimension shaped data: unique build keys, probe keys drawn from them plus some misses,
+// and a skewed group-by column.
+struct Dataset {
+    std::vector<uint64_t> buildKeys;
+    std::vector<uint64_t> probeKeys;
+    std::vector<uint64_t> groupKeys;
+    std::vector<int64_t> groupValues;
+};
+
+Dataset GenerateData(const uint32_t buildRows, const uint32_t probeRows, const uint32_t groups) {
+    std::mt19937_64 rng(42);
+    Dataset data;
+
+    data.buildKeys.resize(buildRows);
+    for (uint32_t i = 0; i < buildRows; ++i) data.buildKeys[i] = rng();
+
+    std::uniform_int_distribution<uint32_t> pick(0, buildRows - 1);
+    data.probeKeys.resize(probeRows);
+    for (uint64_t& key : data.probeKeys) key = rng() % 10 == 0 ? rng() : data.buildKeys[pick(rng)];
+
+    std::geometric_distribution<uint32_t> skew(8.0 / groups);
+    data.groupKeys.resize(probeRows);
+    data.groupValues.resize(probeRows);
+    for (uint32_t i = 0; i < probeRows; ++i) {
+        data.groupKeys[i] = skew(rng) % groups * 0x9E3779B97F4A7C15ULL;
+        data.groupValues[i] = static_cast<int64_t>(rng() % 1000);
+    }
+    return data;
+}
+
+uint64_t JoinChecksum(const JoinResult& result) {
+    uint64_t checksum = result.count;
+    for (size_t i = 0; i < result.count; ++i) {
+        checksum += result.matches[i].buildRow * 31ULL + result.matches[i].probeRow;
+    }
+    return checksum;
+}
+
+uint64_t GroupChecksum(const GroupByResult& result) {
+    uint64_t checksum = result.groupCount;
+    for (size_t g = 0; g < result.groupCount; ++g) {
+        checksum += result.keys[g] ^ (result.counts[g] * 31ULL + result.sums[g]);
+    }
+    return checksum;
+}
+
+int main() {
+    constexpr uint32_t BUILD_ROWS = 1'000'000;
+    constexpr uint32_t PROBE_ROWS = 4'000'000;
+    constexpr uint32_t GROUPS = 100'000;
+    constexpr int TEST_REPEATS = 3;
+
+    const Dataset data = GenerateData(BUILD_ROWS, PROBE_ROWS, GROUPS);
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    constexpr size_t kMiB = 1024 * 1024;
+    ArenaAllocator output(128 * kMiB);
+    ArenaAllocator scratch(256 * kMiB);
+    std::vector<std::unique_ptr<ArenaAllocator>> threadArenaStorage;
+    std::vector<ArenaAllocator*> threadArenas;
+    for (unsigned t = 0; t < threads; ++t) {
+        threadArenaStorage.push_back(std::make_unique<ArenaAllocator>(64 * kMiB));
+        threadArenas.push_back(threadArenaStorage.back().get());
+    }
+
+    std::cout << "--- HASH JOIN / GROUP-BY BENCHMARK ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
+    std::cout << "Build rows: " << BUILD_ROWS << ", Probe rows: " << PROBE_ROWS
+              << ", Groups: ~" << GROUPS << ", Threads: " << threads << "\n\n";
+
+    // Baselines: node-based std containers, one heap allocation per entry.
+    uint64_t stdJoin = 0;
+    const double stdJoinTime = AverageMs(TEST_REPEATS, [&] {
+        std::unordered_multimap<uint64_t, uint32_t> table;
+        for (uint32_t row = 0; row < BUILD_ROWS; ++row) table.emplace(data.buildKeys[row], row);
+        JoinResult result;
+        std::vector<JoinMatch> matches;
+        for (uint32_t row = 0; row < PROBE_ROWS; ++row) {
+            const auto [begin, end] = table.equal_range(data.probeKeys[row]);
+            for (auto it = begin; it != end; ++it) matches.push_back(JoinMatch{it->second, row});
+        }
+        stdJoin = JoinChecksum({matches.data(), matches.size()});
+    });
+
+    uint64_t stdGroup = 0;
+    const double stdGroupTime = AverageMs(TEST_REPEATS, [&] {
+        std::unordered_map<uint64_t, std::pair<uint32_t, int64_t>> groups;
+        for (uint32_t row = 0; row < PROBE_ROWS; ++row) {
+            auto& group = groups[data.groupKeys[row]];
+            ++group.first;
+            group.second += data.groupValues[row];
+        }
+        uint64_t checksum = groups.size();
+        for (const auto& [key, group] : groups) {
+            checksum += key ^ (group.first * 31ULL + group.second);
+        }
+        stdGroup = checksum;
+    });
+
+    uint64_t arenaJoin = 0;
+    const double arenaJoinTime = AverageMs(TEST_REPEATS, [&] {
+        output.Reset();
+        arenaJoin = JoinChecksum(
+            ArenaHashKernels::HashJoin(data.buildKeys, data.probeKeys, output, scratch));
+    });
+
+    uint64_t parallelJoin = 0;
+    const double parallelJoinTime = AverageMs(TEST_REPEATS, [&] {
+        output.Reset();
+        parallelJoin = JoinChecksum(ArenaHashKernels::ParallelHashJoin(
+            data.buildKeys, data.probeKeys, output, scratch, threadArenas));
+    });
+
+    uint64_t arenaGroup = 0;
+    const double arenaGroupTime = AverageMs(TEST_REPEATS, [&] {
+        output.Reset();
+        arenaGroup = GroupChecksum(ArenaHashKernels::HashGroupBy(data.groupKeys, data.groupValues,
+                                                                 output, scratch));
+    });
+
+    uint64_t parallelGroup = 0;
+    const double parallelGroupTime = AverageMs(TEST_REPEATS, [&] {
+        output.Reset();
+        parallelGroup = GroupChecksum(ArenaHashKernels::ParallelHashGroupBy(
+            data.groupKeys, data.groupValues, output, scratch, threadArenas));
+    });
+
+    // Sums of per-row terms, so the checksums do not depend on output order.
+    if (stdJoin != arenaJoin || stdJoin != parallelJoin || stdGroup != arenaGroup ||
+        stdGroup != parallelGroup) {
+        std::cerr << "Checksum mismatch\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Hash join  std::unordered_multimap : " << stdJoinTime << " ms\n";
+    std::cout << "Hash join  arena (1 thread)        : " << arenaJoinTime << " ms ("
+              << stdJoinTime / arenaJoinTime << "x)\n";
+    std::cout << "Hash join  arena (" << threads << " threads)       : " << parallelJoinTime
+              << " ms (" << stdJoinTime / parallelJoinTime << "x)\n";
+    std::cout << "Group-by   std::unordered_map      : " << stdGroupTime << " ms\n";
+    std::cout << "Group-by   arena (1 thread)        : " << arenaGroupTime << " ms ("
+              << stdGroupTime / arenaGroupTime << "x)\n";
+    std::cout << "Group-by   arena (" << threads << " threads)       : " << parallelGroupTime
+              << " ms (" << stdGroupTime / parallelGroupTime << "x)\n";
+    return 0;
+}
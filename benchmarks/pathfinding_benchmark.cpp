@@ -0,0 +1,145 @@
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "arena_priority_queue.h"
+#include "benchmark_utils.h"
+
+// Weighted 4-connected grid with random walls, generated from a fixed seed.
+struct GridGraph {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> weights; // 0 = wall, otherwise cost of entering the cell
+
+    GridGraph(const uint32_t w, const uint32_t h, const uint32_t seed) : width(w), height(h) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> cost(1, 9);
+        std::uniform_int_distribution<int> wall(0, 99);
+
+        weights.resize(static_cast<size_t>(w) * h);
+        for (auto& weight : weights) {
+            weight = wall(rng) < 20 ? 0 : static_cast<uint8_t>(cost(rng));
+        }
+    }
+
+    [[nodiscard]] uint32_t NodeCount() const { return width * height; }
+
+    template <typename Func>
+    void ForEachNeighbor(const uint32_t node, Func func) const {
+        const uint32_t x = node % width;
+        const uint32_t y = node / width;
+
+        if (x > 0) Visit(node - 1, func);
+        if (x + 1 < width) Visit(node + 1, func);
+        if (y > 0) Visit(node - width, func);
+        if (y + 1 < height) Visit(node + width, func);
+    }
+
+private:
+    template <typename Func>
+    void Visit(const uint32_t neighbor, Func& func) const {
+        if (weights[neighbor] != 0) func(neighbor, weights[neighbor]);
+    }
+};
+
+// Baseline: per-query heap vectors and std::priority_queue with lazy deletion of stale entries.
+uint64_t DijkstraStd(const GridGraph& graph, const uint32_t start) {
+    using Entry = std::pair<uint32_t, uint32_t>; // (cost, node)
+    std::vector<uint32_t> cost(graph.NodeCount(), UINT32_MAX);
+    std::vector<uint32_t> parent(graph.NodeCount(), UINT32_MAX);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> open;
+
+    cost[start] = 0;
+    open.emplace(0, start);
+
+    uint64_t checkSum = 0;
+    while (!open.empty()) {
+        const auto [nodeCost, node] = open.top();
+        open.pop();
+        if (nodeCost != cost[node]) continue; // Stale duplicate
+
+        checkSum += nodeCost;
+        graph.ForEachNeighbor(node, [&](const uint32_t next, const uint32_t weight) {
+            const uint32_t candidate = nodeCost + weight;
+            if (candidate < cost[next]) {
+                cost[next] = candidate;
+                parent[next] = node;
+                open.emplace(candidate, next);
+            }
+        });
+    }
+
+    return checkSum;
+}
+
+// Arena: decrease-key heap and records in a scoped region, torn down by the query destructor.
+uint64_t DijkstraArena(ArenaAllocator& arena, const GridGraph& graph, const uint32_t start) {
+    ArenaPathQuery<uint32_t> query(arena, graph.NodeCount());
+    query.Relax(start, ArenaPathQuery<uint32_t>::kNoParent, 0);
+
+    uint64_t checkSum = 0;
+    auto& open = query.Open();
+    while (!open.IsEmpty()) {
+        const uint32_t node = open.Pop();
+        const uint32_t nodeCost = query.Record(node).cost;
+
+        checkSum += nodeCost;
+        graph.ForEachNeighbor(node, [&](const uint32_t next, const uint32_t weight) {
+            query.Relax(next, node, nodeCost + weight);
+        });
+    }
+
+    return checkSum;
+}
+
+int main() {
+    constexpr uint32_t GRID_SIZE = 512;
+    constexpr int QUERIES = 8;
+    constexpr int TEST_REPEATS = 5;
+
+    const GridGraph graph(GRID_SIZE, GRID_SIZE, 42);
+
+    std::vector<uint32_t> starts;
+    std::mt19937 rng(7);
+    while (starts.size() < QUERIES) {
+        const uint32_t node = rng() % graph.NodeCount();
+        if (graph.weights[node] != 0) starts.push_back(node);
+    }
+
+    // Records + heap + positions + priorities, with slack for alignment padding.
+    ArenaAllocator arena(static_cast<size_t>(graph.NodeCount()) * 32 + 4096);
+
+    std::cout << "--- PATHFINDING BENCHMARK ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
+    std::cout << "Grid: " << GRID_SIZE << "x" << GRID_SIZE << ", Queries: " << QUERIES << "\n\n";
+
+    uint64_t stdSum = 0;
+    const double stdTime = AverageMs(TEST_REPEATS, [&] {
+        stdSum = 0;
+        for (const uint32_t start : starts) stdSum += DijkstraStd(graph, start);
+    });
+
+    uint64_t arenaSum = 0;
+    const double arenaTime = AverageMs(TEST_REPEATS, [&] {
+        arenaSum = 0;
+        for (const uint32_t start : starts) arenaSum += DijkstraArena(arena, graph, start);
+    });
+
+    if (stdSum != arenaSum) {
+        std::cerr << "Checksum mismatch: " << stdSum << " vs " << arenaSum << "\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "std::priority_queue (lazy deletion): " << stdTime << " ms\n";
+    std::cout << "Arena indexed 4-ary heap           : " << arenaTime << " ms\n";
+    std::cout << "Speedup Factor: " << stdTime / arenaTime << "x\n";
+    std::cout << "Arena used after queries: " << arena.GetUsedMemory() << " bytes\n";
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(ARENA_ENABLE_SAMPLING)
+#include "arena_profiler.h"
+#else
+#include "arena_allocator.h"
+#endif
+#include "benchmark_utils.h"
+
+constexpr uint32_t ALLOCATION_COUNT = 1'000'000;
+constexpr int FRAMES_PER_ROUND = 20;
+constexpr int ROUNDS = 7;
+
+// Mixed small allocations, the pattern where a per-allocation hook would hurt the most.
+// Kept out of line in both builds: the frame gets its arena by reference, as real frame code
+// does, so the comparison measures Alloc() rather than whether the compiler happens to inline
+// the whole loop into main() and keep a local arena in registers.
+[[gnu::noinline]] uint64_t RunFrame(ArenaAllocator& arena, const uint32_t allocationCount) {
+    arena.Reset();
+    uint64_t checksum = 0;
+    for (uint32_t i = 0; i < allocationCount; ++i) {
+        const size_t size = 16 + (i * 37) % 241;
+        auto* bytes = static_cast<uint8_t*>(arena.Alloc(size, 8));
+        bytes[0] = static_cast<uint8_t>(i);
+        checksum += bytes[0];
+    }
+    return checksum;
+}
+
+// Medians rather than averages: a single preempted frame moves the average by several percent,
+// which would hide the sub-percent differences this benchmark is about.
+double Median(std::vector<double> values) {
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+double MedianFrameMs(ArenaAllocator& arena, uint64_t& checksum) {
+    std::vector<double> times;
+    for (int i = 0; i < FRAMES_PER_ROUND; ++i) {
+        times.push_back(MeasureMs([&] { checksum += RunFrame(arena, ALLOCATION_COUNT); }));
+    }
+    return Median(times);
+}
+
+#if !defined(ARENA_ENABLE_SAMPLING)
+
+// profiler_baseline_benchmark: the same frames with no sampling code in Alloc() at all.
+// profiler_benchmark runs this binary once per round and reads the line below.
+int main() {
+    ArenaAllocator arena(static_cast<size_t>(ALLOCATION_COUNT) * 264);
+    uint64_t checksum = 0;
+    MedianFrameMs(arena, checksum); // Warm up pages and caches as long as the parent did
+    const double time = MedianFrameMs(arena, checksum);
+    std::printf("Hook compiled out: %.4f ms (checksum %llu)\n", time,
+                static_cast<unsigned long long>(checksum));
+    return 0;
+}
+
+#else
+
+// Runs the baseline build in its own process; -1 if it is unavailable.
+double RunBaseline() {
+#if defined(PROFILER_BASELINE_PATH) && (defined(__unix__) || defined(__APPLE__))
+    FILE* pipe = popen(PROFILER_BASELINE_PATH, "r");
+    if (!pipe) return -1.0;
+    double time = -1.0;
+    if (std::fscanf(pipe, "Hook compiled out: %lf", &time) != 1) time = -1.0;
+    pclose(pipe);
+    return time;
+#else
+    return -1.0;
+#endif
+}
+
+void PrintOverhead(const char* label, const double time, const double baseline) {
+    std::cout << label << time << " ms";
+    if (baseline > 0.0) std::cout << " (" << (time / baseline - 1.0) * 100.0 << "% overhead)";
+    std::cout << "\n";
+}
+
+int main() {
+    ArenaAllocator arena(static_cast<size_t>(ALLOCATION_COUNT) * 264);
+    ArenaSamplingProfiler& profiler = ArenaSamplingProfiler::Instance();
+    uint64_t checksum = 0;
+
+    std::cout << "--- SAMPLING PROFILER OVERHEAD ---\n";
+    std::cout << "Allocations per frame: " << ALLOCATION_COUNT
+              << ", Sample interval: " << ArenaSamplingProfiler::kDefaultSampleInterval
+              << " bytes\n";
+    std::cout << "Median of " << ROUNDS << " rounds x " << FRAMES_PER_ROUND << " frames\n\n";
+
+    RunFrame(arena, ALLOCATION_COUNT); // Warm up the pages
+
+    // Rounds alternate between the three builds/modes so that drift in machine load hits all
+    // of them alike instead of whichever happened to run last.
+    std::vector<double> baselineTimes;
+    std::vector<double> idleTimes;
+    std::vector<double> sampledTimes;
+    uint64_t samples = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const double baseline = RunBaseline();
+        if (baseline > 0.0) baselineTimes.push_back(baseline);
+        idleTimes.push_back(MedianFrameMs(arena, checksum));
+
+        profiler.Start();
+        sampledTimes.push_back(MedianFrameMs(arena, checksum));
+        profiler.Stop();
+        samples += profiler.GetSampleCount();
+    }
+
+    const double baselineTime = baselineTimes.empty() ? -1.0 : Median(baselineTimes);
+    const double idleTime = Median(idleTimes);
+    const double sampledTime = Median(sampledTimes);
+
+    const char* foldedPath = "arena_profile.folded";
+    const bool written = profiler.WriteFolded(foldedPath);
+
+    std::cout << std::fixed << std::setprecision(2);
+    if (baselineTime > 0.0) std::cout << "Hook compiled out      : " << baselineTime << " ms\n";
+    else std::cout << "Hook compiled out      : n/a (profiler_baseline_benchmark not built)\n";
+    PrintOverhead("Hook compiled in, idle : ", idleTime, baselineTime);
+    PrintOverhead("Sampling (default rate): ", sampledTime, baselineTime);
+    std::cout << "Samples per frame      : "
+              << static_cast<double>(samples) / (ROUNDS * FRAMES_PER_ROUND) << "\n";
+    std::cout << "Folded profile         : " << (written ? foldedPath : "(write failed)") << "\n";
+    std::cout << "Checksum               : " << checksum << "\n";
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena_string_table.h"
+#include "benchmark_utils.h"
+
+// Log-like keys: a few shared prefixes, a skewed id and an optional suffix, so many repeat.
+std::vector<std::string> GenerateKeys(const uint32_t count, const uint32_t seed) {
+    static const char* const kPrefixes[] = {"GET /api/v1/users/", "GET /api/v1/orders/",
+                                            "POST /api/v2/checkout/", "GET /static/img/"};
+    std::mt19937 rng(seed);
+    std::geometric_distribution<uint32_t> id(0.0005);
+
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string key = kPrefixes[rng() % 4] + std::to_string(id(rng));
+        if (rng() % 3 == 0) key += "?page=" + std::to_string(rng() % 20);
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+// The sort-and-group stage: sort, then count runs of equal keys.
+uint64_t SortAndGroupStrings(std::vector<std::string> keys) {
+    std::sort(keys.begin(), keys.end());
+    uint64_t groups = keys.empty() ? 0 : 1;
+    for (size_t i = 1; i < keys.size(); ++i) groups += keys[i] != keys[i - 1];
+    return groups;
+}
+
+uint64_t SortAndGroupTable(const std::vector<std::string>& keys, ArenaAllocator& arena,
+                           const unsigned threads) {
+    ArenaScope batch(arena);
+    size_t bytes = 0;
+    for (const std::string& key : keys) bytes += key.size();
+
+    ArenaStringTable table(arena);
+    table.Reserve(keys.size(), bytes);
+    for (const std::string& key : keys) table.Append(key);
+
+    auto* order = arena.AllocArray<uint32_t>(table.Size());
+    table.Sort(order, arena, threads);
+    uint64_t groups = table.IsEmpty() ? 0 : 1;
+    for (size_t i = 1; i < table.Size(); ++i) groups += !table.Equals(order[i], order[i - 1]);
+    return groups;
+}
+
+int main() {
+    constexpr uint32_t KEY_COUNT = 1'000'000;
+    constexpr int TEST_REPEATS = 5;
+
+    const std::vector<std::string> keys = GenerateKeys(KEY_COUNT, 42);
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    ArenaAllocator arena(64 * 1024 * 1024);
+
+    std::cout << "--- STRING TABLE SORT-AND-GROUP BENCHMARK ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
+    std::cout << "Keys: " << KEY_COUNT << ", Threads: " << threads << "\n\n";
+
+    // The std::string baseline includes copying the batch, as the table path includes building it.
+    uint64_t stringGroups = 0;
+    const double stringTime =
+        AverageMs(TEST_REPEATS, [&] { stringGroups = SortAndGroupStrings(keys); });
+
+    uint64_t serialGroups = 0;
+    const double serialTime =
+        AverageMs(TEST_REPEATS, [&] { serialGroups = SortAndGroupTable(keys, arena, 1); });
+
+    uint64_t parallelGroups = 0;
+    const double parallelTime =
+        AverageMs(TEST_REPEATS, [&] { parallelGroups = SortAndGroupTable(keys, arena, threads); });
+
+    if (stringGroups != serialGroups || stringGroups != parallelGroups) {
+        std::cerr << "Group count mismatch: " << stringGroups << " vs " << serialGroups << " vs "
+                  << parallelGroups << "\n";
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Distinct keys                        : " << stringGroups << "\n";
+    std::cout << "std::vector<std::string> + std::sort : " << stringTime << " ms\n";
+    std::cout << "ArenaStringTable radix sort (1 thr)  : " << serialTime << " ms\n";
+    std::cout << "ArenaStringTable radix sort (" << threads << " thr)  : " << parallelTime
+              << " ms\n";
+    std::cout << "Speedup (serial / parallel)          : " << stringTime / serialTime << "x / "
+              << stringTime / parallelTime << "x\n";
+    return 0;
+}
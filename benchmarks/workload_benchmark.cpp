@@ -0,0 +1,747 @@
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arena_format.h"
+#include "arena_memory_resource.h"
+#include "arena_radix_tree.h"
+#include "arena_small_vector.h"
+#include "benchmark_utils.h"
+
+// End-to-end workloads, each written once against a memory policy and run three ways:
+//   heap  - std containers, new/delete per object
+//   pmr   - std::pmr containers over ArenaMemoryResource, arena reset per frame
+//   arena - the library's own containers (ArenaSmallVector, ArenaRadixTree, ArenaStringBuilder)
+// All input is generated from fixed seeds, so every variant must produce the same checksum.
+
+// ---------------------------------------------------------------------------------------------
+// Memory policies
+
+struct HeapPolicy {
+    static constexpr const char* kName = "heap";
+    static constexpr bool kUsesArena = false;
+    static constexpr bool kDeletesObjects = true;
+
+    using String = std::string;
+    template <typename T>
+    using Vector = std::vector<T>;
+    using Map = std::unordered_map<std::string, std::string>;
+    using Text = std::string;
+
+    String MakeString(const std::string_view text) { return String(text); }
+    template <typename T>
+    Vector<T> MakeVector() { return {}; }
+    Map MakeMap() { return {}; }
+    Text MakeText() { return {}; }
+
+    explicit HeapPolicy(ArenaAllocator&) {} // Same shape as the other policies; arena unused
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) { return new T(std::forward<Args>(args)...); }
+    template <typename T>
+    void Delete(T* object) { delete object; }
+
+    void EndFrame() {}
+};
+
+struct PmrPolicy {
+    static constexpr const char* kName = "pmr";
+    static constexpr bool kUsesArena = true;
+    static constexpr bool kDeletesObjects = false;
+
+    using String = std::pmr::string;
+    template <typename T>
+    using Vector = std::pmr::vector<T>;
+    using Map = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
+    using Text = std::pmr::string;
+
+    explicit PmrPolicy(ArenaAllocator& arena) : resource(arena) {}
+
+    String MakeString(const std::string_view text) { return String(text, &resource); }
+    template <typename T>
+    Vector<T> MakeVector() { return Vector<T>(&resource); }
+    Map MakeMap() { return Map(&resource); }
+    Text MakeText() { return Text(&resource); }
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        return std::pmr::polymorphic_allocator<>(&resource).new_object<T>(
+            std::forward<Args>(args)...);
+    }
+    template <typename T>
+    void Delete(T*) {}
+
+    void EndFrame() { resource.GetArena().Reset(); }
+
+    ArenaMemoryResource resource;
+};
+
+struct ArenaPolicy {
+    static constexpr const char* kName = "arena";
+    static constexpr bool kUsesArena = true;
+    static constexpr bool kDeletesObjects = false;
+
+    using String = std::string_view; // Bytes copied into the arena
+    template <typename T>
+    using Vector = ArenaSmallVector<T, 4>;
+    using Map = ArenaRadixTree<std::string_view>;
+    using Text = ArenaStringBuilder;
+
+    explicit ArenaPolicy(ArenaAllocator& frameArena) : arena(&frameArena) {}
+
+    String MakeString(const std::string_view text) {
+        char* copy = arena->AllocArray<char>(text.size());
+        if (!copy && !text.empty()) throw std::bad_alloc();
+        if (!text.empty()) std::memcpy(copy, text.data(), text.size());
+        return {copy, text.size()};
+    }
+    template <typename T>
+    Vector<T> MakeVector() { return Vector<T>(*arena); }
+    Map MakeMap() { return Map(*arena); }
+    Text MakeText() { return Text(*arena); }
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        T* object = arena->New<T>(std::forward<Args>(args)...);
+        if (!object) throw std::bad_alloc();
+        return object;
+    }
+    template <typename T>
+    void Delete(T*) {}
+
+    void EndFrame() { arena->Reset(); }
+
+    ArenaAllocator* arena;
+};
+
+// Small adapters over the std and arena spellings of the same operations.
+
+template <typename Vec, typename T>
+void Append(Vec& vec, T value) {
+    if constexpr (requires { vec.push_back(value); }) vec.push_back(value);
+    else vec.PushBack(value);
+}
+
+template <typename Vec>
+size_t Count(const Vec& vec) {
+    if constexpr (requires { vec.size(); }) return vec.size();
+    else return vec.Size();
+}
+
+template <typename Text>
+void AppendText(Text& text, const std::string_view piece) {
+    if constexpr (requires { text.append(piece); }) text.append(piece);
+    else text.Append(piece);
+}
+
+template <typename Text>
+size_t FinishText(Text& text) {
+    if constexpr (requires { text.Finish(); }) return text.Finish().size();
+    else return text.size();
+}
+
+template <typename Policy>
+void MapInsert(Policy& policy, typename Policy::Map& map, const std::string_view key,
+               const std::string_view value) {
+    if constexpr (requires { map.emplace(policy.MakeString(key), policy.MakeString(value)); }) {
+        map.emplace(policy.MakeString(key), policy.MakeString(value));
+    } else {
+        map.Insert(key, policy.MakeString(value));
+    }
+}
+
+template <typename Map>
+std::string_view MapFind(const Map& map, const std::string_view key) {
+    if constexpr (requires { map.Find(key); }) {
+        const std::string_view* value = map.Find(key);
+        return value ? *value : std::string_view();
+    } else {
+        // No transparent hashing here, so the lookup key is a temporary string, as in most code.
+        const auto it = map.find(typename Map::key_type(key, map.get_allocator()));
+        return it != map.end() ? std::string_view(it->second) : std::string_view();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Workload 1: JSON-like document parsed into a DOM tree
+
+std::string GenerateJson(const uint32_t records, const uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string json = "[";
+    for (uint32_t i = 0; i < records; ++i) {
+        if (i > 0) json += ',';
+        json += "{\"id\":" + std::to_string(i);
+        json += ",\"name\":\"user_" + std::to_string(rng() % 100000) + "\"";
+        json += ",\"active\":" + std::string(rng() % 2 ? "true" : "false");
+        json += ",\"score\":" + std::to_string(static_cast<double>(rng() % 10000) / 100.0);
+        json += ",\"tags\":[";
+        const uint32_t tagCount = rng() % 6;
+        for (uint32_t t = 0; t < tagCount; ++t) {
+            if (t > 0) json += ',';
+            json += "\"tag" + std::to_string(rng() % 50) + "\"";
+        }
+        json += "],\"position\":{\"x\":" + std::to_string(rng() % 1000) +
+                ",\"y\":" + std::to_string(rng() % 1000) + ",\"history\":[";
+        const uint32_t historyCount = rng() % 9;
+        for (uint32_t h = 0; h < historyCount; ++h) {
+            if (h > 0) json += ',';
+            json += std::to_string(rng() % 100);
+        }
+        json += "]},\"parent\":null}";
+    }
+    json += "]";
+    return json;
+}
+
+template <typename Policy>
+struct JsonNode {
+    enum class Kind : uint8_t { Null, Bool, Number, String, Array, Object };
+
+    JsonNode(const Kind nodeKind, typename Policy::String nodeKey,
+             typename Policy::String nodeText,
+             typename Policy::template Vector<JsonNode*> nodeChildren)
+        : kind(nodeKind), key(std::move(nodeKey)), text(std::move(nodeText)),
+          children(std::move(nodeChildren)) {}
+
+    Kind kind;
+    double number = 0.0;
+    typename Policy::String key;
+    typename Policy::String text;
+    typename Policy::template Vector<JsonNode*> children;
+};
+
+// Minimal recursive-descent parser for the generator's output (no escapes, no exponents).
+template <typename Policy>
+class JsonParser {
+public:
+    using Node = JsonNode<Policy>;
+
+    JsonParser(Policy& policy, const std::string_view input) : m_policy(policy), m_input(input) {}
+
+    Node* Parse() { return ParseValue({}); }
+
+private:
+    Node* ParseValue(const std::string_view key) {
+        const char c = m_input[m_position];
+        if (c == '{' || c == '[') {
+            const bool isObject = c == '{';
+            Node* node = MakeNode(isObject ? Node::Kind::Object : Node::Kind::Array, key, {});
+            ++m_position;
+            while (m_input[m_position] != (isObject ? '}' : ']')) {
+                std::string_view childKey;
+                if (isObject) {
+                    childKey = ParseString();
+                    ++m_position; // ':'
+                }
+                Append(node->children, ParseValue(childKey));
+                if (m_input[m_position] == ',') ++m_position;
+            }
+            ++m_position;
+            return node;
+        }
+        if (c == '"') return MakeNode(Node::Kind::String, key, ParseString());
+        if (c == 't' || c == 'f') {
+            Node* node = MakeNode(Node::Kind::Bool, key, {});
+            node->number = c == 't' ? 1.0 : 0.0;
+            m_position += c == 't' ? 4 : 5;
+            return node;
+        }
+        if (c == 'n') {
+            m_position += 4;
+            return MakeNode(Node::Kind::Null, key, {});
+        }
+
+        Node* node = MakeNode(Node::Kind::Number, key, {});
+        const auto result = std::from_chars(m_input.data() + m_position,
+                                            m_input.data() + m_input.size(), node->number);
+        m_position = static_cast<size_t>(result.ptr - m_input.data());
+        return node;
+    }
+
+    std::string_view ParseString() {
+        const size_t start = m_position + 1;
+        const size_t end = m_input.find('"', start);
+        m_position = end + 1;
+        return m_input.substr(start, end - start);
+    }
+
+    Node* MakeNode(const typename Node::Kind kind, const std::string_view key,
+                   const std::string_view text) {
+        return m_policy.template New<Node>(kind, m_policy.MakeString(key),
+                                           m_policy.MakeString(text),
+                                           m_policy.template MakeVector<Node*>());
+    }
+
+    Policy& m_policy;
+    std::string_view m_input;
+    size_t m_position = 0;
+};
+
+template <typename Policy>
+uint64_t SumJson(const JsonNode<Policy>* node) {
+    uint64_t sum = static_cast<uint64_t>(node->number * 100.0) + node->key.size() +
+                   node->text.size() + Count(node->children);
+    for (const JsonNode<Policy>* child : node->children) sum += SumJson(child);
+    return sum;
+}
+
+template <typename Policy>
+void DeleteJson(Policy& policy, JsonNode<Policy>* node) {
+    for (JsonNode<Policy>* child : node->children) DeleteJson(policy, child);
+    policy.Delete(node);
+}
+
+template <typename Policy>
+uint64_t RunJsonWorkload(Policy& policy, const std::string& json) {
+    uint64_t checksum = 0;
+    {
+        JsonNode<Policy>* root = JsonParser<Policy>(policy, json).Parse();
+        checksum = SumJson(root);
+        if constexpr (Policy::kDeletesObjects) DeleteJson(policy, root);
+    }
+    policy.EndFrame();
+    return checksum;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Workload 2: compiler front end - parse statements to an AST, constant-fold, evaluate
+
+std::string GenerateProgram(const uint32_t statements, const uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string program;
+
+    auto expression = [&](auto& self, const uint32_t statement, const int depth) -> std::string {
+        if (depth == 0 || rng() % 3 == 0) {
+            if (statement > 0 && rng() % 2 == 0) return "v" + std::to_string(rng() % statement);
+            return std::to_string(rng() % 100);
+        }
+        static constexpr char kOps[] = {'+', '-', '*'};
+        std::string lhs = self(self, statement, depth - 1);
+        std::string rhs = self(self, statement, depth - 1);
+        return "(" + lhs + kOps[rng() % 3] + rhs + ")";
+    };
+
+    for (uint32_t s = 0; s < statements; ++s) {
+        program += "let v" + std::to_string(s) + " = " + expression(expression, s, 6) + ";\n";
+    }
+    return program;
+}
+
+template <typename Policy>
+struct Expr {
+    Expr(const char exprOp, const uint64_t exprValue, typename Policy::String exprName, Expr* left,
+         Expr* right)
+        : op(exprOp), value(exprValue), name(std::move(exprName)), lhs(left), rhs(right) {}
+
+    char op; // 'n' number, 'v' variable, otherwise a binary operator
+    uint64_t value;
+    typename Policy::String name;
+    Expr* lhs;
+    Expr* rhs;
+};
+
+template <typename Policy>
+class Compiler {
+public:
+    using Node = Expr<Policy>;
+
+    explicit Compiler(Policy& policy) : m_policy(policy) {}
+
+    /** @return Sum of all variables, folded and evaluated in statement order */
+    uint64_t Run(const std::string_view program) {
+        m_input = program;
+        m_position = 0;
+
+        auto statements = m_policy.template MakeVector<Node*>();
+        while (m_position < m_input.size()) {
+            m_position = m_input.find('=', m_position) + 2; // Skip "let vN = "
+            Append(statements, ParseExpr());
+            m_position += 2; // ";\n"
+        }
+
+        auto folded = m_policy.template MakeVector<Node*>();
+        for (Node* statement : statements) {
+            Append(folded, Fold(statement));
+            if constexpr (Policy::kDeletesObjects) DeleteTree(statement);
+        }
+
+        auto values = m_policy.template MakeVector<uint64_t>();
+        uint64_t sum = 0;
+        for (Node* statement : folded) {
+            const uint64_t value = Evaluate(statement, values);
+            Append(values, value);
+            sum += value;
+            if constexpr (Policy::kDeletesObjects) DeleteTree(statement);
+        }
+        return sum;
+    }
+
+private:
+    Node* ParseExpr() {
+        const char c = m_input[m_position];
+        if (c == '(') {
+            ++m_position;
+            Node* lhs = ParseExpr();
+            const char op = m_input[m_position++];
+            Node* rhs = ParseExpr();
+            ++m_position; // ')'
+            return m_policy.template New<Node>(op, 0, m_policy.MakeString({}), lhs, rhs);
+        }
+
+        const size_t start = m_position;
+        while (m_position < m_input.size() &&
+               std::isalnum(static_cast<unsigned char>(m_input[m_position]))) {
+            ++m_position;
+        }
+        const std::string_view token = m_input.substr(start, m_position - start);
+        if (c == 'v') {
+            return m_policy.template New<Node>('v', 0, m_policy.MakeString(token), nullptr,
+                                               nullptr);
+        }
+
+        uint64_t value = 0;
+        std::from_chars(token.data(), token.data() + token.size(), value);
+        return m_policy.template New<Node>('n', value, m_policy.MakeString({}), nullptr, nullptr);
+    }
+
+    // Builds a new, folded tree, the way a compiler pass produces its output IR.
+    Node* Fold(const Node* node) {
+        if (node->op == 'n' || node->op == 'v') {
+            return m_policy.template New<Node>(node->op, node->value,
+                                               m_policy.MakeString(node->name), nullptr, nullptr);
+        }
+        Node* lhs = Fold(node->lhs);
+        Node* rhs = Fold(node->rhs);
+        if (lhs->op == 'n' && rhs->op == 'n') {
+            const uint64_t value = Apply(node->op, lhs->value, rhs->value);
+            if constexpr (Policy::kDeletesObjects) {
+                m_policy.Delete(lhs);
+                m_policy.Delete(rhs);
+            }
+            return m_policy.template New<Node>('n', value, m_policy.MakeString({}), nullptr,
+                                               nullptr);
+        }
+        return m_policy.template New<Node>(node->op, 0, m_policy.MakeString({}), lhs, rhs);
+    }
+
+    template <typename Values>
+    uint64_t Evaluate(const Node* node, const Values& values) const {
+        if (node->op == 'n') return node->value;
+        if (node->op == 'v') {
+            size_t index = 0;
+            std::from_chars(node->name.data() + 1, node->name.data() + node->name.size(), index);
+            return values[index];
+        }
+        return Apply(node->op, Evaluate(node->lhs, values), Evaluate(node->rhs, values));
+    }
+
+    static uint64_t Apply(const char op, const uint64_t lhs, const uint64_t rhs) {
+        return op == '+' ? lhs + rhs : op == '-' ? lhs - rhs : lhs * rhs;
+    }
+
+    void DeleteTree(Node* node) {
+        if (!node) return;
+        DeleteTree(node->lhs);
+        DeleteTree(node->rhs);
+        m_policy.Delete(node);
+    }
+
+    Policy& m_policy;
+    std::string_view m_input;
+    size_t m_position = 0;
+};
+
+template <typename Policy>
+uint64_t RunCompilerWorkload(Policy& policy, const std::string& program) {
+    const uint64_t checksum = Compiler<Policy>(policy).Run(program);
+    policy.EndFrame();
+    return checksum;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Workload 3: particle simulation frames - spawn, integrate, gather, discard
+
+struct SimParticle {
+    float x, y, z;
+    float vx, vy, vz;
+    uint32_t id;
+};
+
+template <typename Policy>
+uint64_t RunParticleWorkload(Policy& policy, const uint32_t frames, const uint32_t count) {
+    uint64_t checksum = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        {
+            auto live = policy.template MakeVector<SimParticle*>();
+            uint32_t state = 12345u + frame;
+            for (uint32_t i = 0; i < count; ++i) {
+                state = state * 1664525u + 1013904223u; // LCG: cheap, identical for all variants
+                const float spread = static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+                Append(live, policy.template New<SimParticle>(SimParticle{
+                    spread * 100.0f, 0.0f, spread * 50.0f, spread - 0.5f, 2.0f, 0.5f - spread, i}));
+            }
+
+            for (int step = 0; step < 4; ++step) {
+                for (SimParticle* p : live) {
+                    p->vy -= 0.981f * 0.016f;
+                    p->x += p->vx * 0.016f;
+                    p->y += p->vy * 0.016f;
+                    p->z += p->vz * 0.016f;
+                }
+            }
+
+            auto inside = policy.template MakeVector<SimParticle*>();
+            for (SimParticle* p : live) {
+                if (p->x < 50.0f && p->z < 25.0f) Append(inside, p);
+            }
+            checksum += Count(inside);
+            for (const SimParticle* p : inside) checksum += p->id;
+
+            if constexpr (Policy::kDeletesObjects) {
+                for (SimParticle* p : live) policy.Delete(p);
+            }
+        }
+        policy.EndFrame();
+    }
+    return checksum;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Workload 4: request loop - parse headers into a map, look some up, build a response
+
+std::vector<std::string> GenerateRequests(const uint32_t count, const uint32_t seed) {
+    std::mt19937 rng(seed);
+    static constexpr const char* kAgents[] = {"curl/8.4.0", "Mozilla/5.0 (X11; Linux x86_64)",
+                                              "load-tester/1.2", "okhttp/4.12"};
+    std::vector<std::string> requests;
+    requests.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string request =
+            "GET /api/v1/items/" + std::to_string(rng() % 100000) + " HTTP/1.1\r\n";
+        request += "Host: service-" + std::to_string(rng() % 16) + ".internal\r\n";
+        request += "User-Agent: " + std::string(kAgents[rng() % 4]) + "\r\n";
+        request += "Accept: application/json\r\n";
+        request += "X-Request-Id: " + std::to_string(rng()) + "-" + std::to_string(rng()) + "\r\n";
+        request += "Cookie: session=" + std::to_string(rng()) + "; theme=dark\r\n";
+        const uint32_t extra = rng() % 6;
+        for (uint32_t e = 0; e < extra; ++e) {
+            request += "X-Trace-" + std::to_string(e) + ": " + std::to_string(rng()) + "\r\n";
+        }
+        request += "\r\n";
+        requests.push_back(std::move(request));
+    }
+    return requests;
+}
+
+template <typename Policy>
+uint64_t RunRequestWorkload(Policy& policy, const std::vector<std::string>& requests) {
+    uint64_t checksum = 0;
+    for (const std::string& raw : requests) {
+        {
+            const std::string_view request(raw);
+            size_t lineEnd = request.find("\r\n");
+            const std::string_view requestLine = request.substr(0, lineEnd);
+            const std::string_view path =
+                requestLine.substr(4, requestLine.rfind(' ') - 4); // After "GET "
+
+            typename Policy::Map headers = policy.MakeMap();
+            for (size_t start = lineEnd + 2; start < request.size(); start = lineEnd + 2) {
+                lineEnd = request.find("\r\n", start);
+                if (lineEnd == start) break; // Blank line ends the headers
+                const std::string_view line = request.substr(start, lineEnd - start);
+                const size_t colon = line.find(':');
+                MapInsert(policy, headers, line.substr(0, colon), line.substr(colon + 2));
+            }
+
+            const std::string_view host = MapFind(headers, "Host");
+            const std::string_view requestId = MapFind(headers, "X-Request-Id");
+            const std::string_view agent = MapFind(headers, "User-Agent");
+
+            typename Policy::Text response = policy.MakeText();
+            AppendText(response, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n");
+            AppendText(response, "X-Request-Id: ");
+            AppendText(response, requestId);
+            AppendText(response, "\r\n\r\n{\"path\":\"");
+            AppendText(response, path);
+            AppendText(response, "\",\"host\":\"");
+            AppendText(response, host);
+            AppendText(response, "\",\"agent\":\"");
+            AppendText(response, agent);
+            AppendText(response, "\"}");
+            checksum += FinishText(response);
+        }
+        policy.EndFrame();
+    }
+    return checksum;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Harness
+
+struct VariantResult {
+    const char* name;
+    double ms;
+    long rssGrowthKb; // Peak RSS above the level at the start of the variant; -1 if unknown
+    long long cacheMisses;
+    uint64_t checksum;
+    PageFaultCounts faults; // During the variant, warm-up included
+    long long reservedBytes; // Arena block size, or what malloc holds from the OS for heap
+    long long usedBytes; // Arena high-water mark; -1 for heap (no cheap peak-in-use figure)
+};
+
+// Each variant gets a fresh arena (and policy), so pages touched by one never count for another.
+template <typename Policy, typename Workload>
+VariantResult RunVariant(const int repeats, Workload workload) {
+    constexpr size_t kArenaBytes = 256 * 1024 * 1024; // Only touched pages become resident
+    VariantResult result{Policy::kName, 0.0, -1, -1, 0, {}, -1, -1};
+
+    const PageFaultCounts faultsBefore = ReadPageFaults();
+    const bool peakReset = ResetPeakRss();
+    const long baselineKb = ReadProcStatusKb("VmRSS:");
+    // The arena block comes from malloc too: the heap variant gets a token one, or its reserved
+    // column would count 256 MB that it never uses.
+    ArenaAllocator arena(Policy::kUsesArena ? kArenaBytes : 1);
+    Policy policy(arena);
+    workload(policy); // Warm-up: fault the pages in before timing; still counted for RSS
+
+    CacheMissCounter counter;
+    counter.Start();
+    result.ms = AverageMs(repeats, [&] { result.checksum = workload(policy); });
+    result.cacheMisses = counter.Stop();
+    if (peakReset && baselineKb >= 0) result.rssGrowthKb = PeakRssKb() - baselineKb;
+
+    const PageFaultCounts faultsAfter = ReadPageFaults();
+    if (faultsBefore.minor >= 0) {
+        result.faults.minor = faultsAfter.minor - faultsBefore.minor;
+        result.faults.major = faultsAfter.major - faultsBefore.major;
+    }
+    if constexpr (Policy::kUsesArena) {
+        result.reservedBytes = static_cast<long long>(arena.GetTotalSize());
+        result.usedBytes = static_cast<long long>(arena.GetHighWaterMark());
+    } else {
+        result.reservedBytes = MallocSystemBytes();
+    }
+    return result;
+}
+
+void PrintMegabytes(const long long bytes, const int width) {
+    std::cout << std::setw(width);
+    if (bytes >= 0) std::cout << static_cast<double>(bytes) / (1024.0 * 1024.0);
+    else std::cout << "n/a";
+}
+
+// Footprint mode: what each backend costs in memory rather than in time.
+void PrintFootprint(const std::array<VariantResult, 3>& results) {
+    std::cout << std::left << std::setw(8) << "variant" << std::right << std::setw(14)
+              << "+peak RSS MB" << std::setw(14) << "minor faults" << std::setw(14)
+              << "major faults" << std::setw(14) << "reserved MB" << std::setw(12) << "used MB"
+              << "\n";
+    for (const VariantResult& result : results) {
+        std::cout << std::left << std::setw(8) << result.name << std::right << std::fixed
+                  << std::setprecision(2);
+        PrintMegabytes(result.rssGrowthKb >= 0 ? result.rssGrowthKb * 1024LL : -1, 14);
+        std::cout << std::setw(14) << result.faults.minor << std::setw(14) << result.faults.major;
+        PrintMegabytes(result.reservedBytes, 14);
+        PrintMegabytes(result.usedBytes, 12);
+        std::cout << "\n";
+    }
+}
+
+bool PrintWorkload(const char* title, const char* unit, const double unitsPerRun,
+                   const std::array<VariantResult, 3>& results, const bool footprint) {
+    std::cout << "\n" << title << "\n";
+    if (footprint) {
+        PrintFootprint(results);
+        for (const VariantResult& result : results) {
+            if (result.checksum != results[0].checksum) {
+                std::cerr << "Checksum mismatch in " << title << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::cout << std::left << std::setw(8) << "variant" << std::right << std::setw(12) << "time ms"
+              << std::setw(20) << unit << std::setw(14) << "+peak RSS MB" << std::setw(16)
+              << "cache misses" << std::setw(10) << "speedup\n";
+
+    bool consistent = true;
+    for (const VariantResult& result : results) {
+        std::cout << std::left << std::setw(8) << result.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << result.ms << std::setw(20)
+                  << unitsPerRun / (result.ms / 1000.0) / 1e6 << std::setw(14);
+        if (result.rssGrowthKb >= 0) std::cout << static_cast<double>(result.rssGrowthKb) / 1024.0;
+        else std::cout << "n/a";
+        std::cout << std::setw(16);
+        if (result.cacheMisses >= 0) std::cout << result.cacheMisses;
+        else std::cout << "n/a";
+        std::cout << std::setw(9) << results[0].ms / result.ms << "x\n";
+        consistent = consistent && result.checksum == results[0].checksum;
+    }
+    if (!consistent) std::cerr << "Checksum mismatch in " << title << "\n";
+    return consistent;
+}
+
+int main(int argc, char** argv) {
+    // --footprint: report RSS, page faults and reserved vs used bytes instead of speed.
+    const bool footprint = argc > 1 && std::string_view(argv[1]) == "--footprint";
+
+    constexpr uint32_t JSON_RECORDS = 20'000;
+    constexpr uint32_t STATEMENTS = 20'000;
+    constexpr uint32_t PARTICLE_FRAMES = 20;
+    constexpr uint32_t PARTICLES = 50'000;
+    constexpr uint32_t REQUESTS = 50'000;
+    constexpr int TEST_REPEATS = 5;
+
+    const std::string json = GenerateJson(JSON_RECORDS, 42);
+    const std::string program = GenerateProgram(STATEMENTS, 7);
+    const std::vector<std::string> requests = GenerateRequests(REQUESTS, 99);
+
+    std::cout << "--- APPLICATION WORKLOAD BENCHMARK ---\n";
+    std::cout << "Heap allocator: " << kHeapAllocatorName << "\n";
+    if (footprint) {
+        std::cout << "Footprint mode: +peak RSS is the growth during each variant, reserved is\n"
+                     "the arena block (or malloc's OS memory), used is the arena high-water mark\n";
+    } else {
+        std::cout << "Throughput in millions of units per second; +peak RSS is the growth during "
+                     "each variant\n";
+    }
+    std::cout << "(heap can show 0 RSS growth when malloc reuses memory freed by earlier runs)\n";
+
+    bool ok = true;
+
+    auto runAll = [](auto workload) {
+        return std::array<VariantResult, 3>{RunVariant<HeapPolicy>(TEST_REPEATS, workload),
+                                            RunVariant<PmrPolicy>(TEST_REPEATS, workload),
+                                            RunVariant<ArenaPolicy>(TEST_REPEATS, workload)};
+    };
+
+    ok &= PrintWorkload("JSON parse + DOM build", "MB/s", static_cast<double>(json.size()),
+                        runAll([&](auto& policy) { return RunJsonWorkload(policy, json); }),
+                        footprint);
+    ok &= PrintWorkload("AST parse + constant folding", "M statements/s", STATEMENTS,
+                        runAll([&](auto& policy) { return RunCompilerWorkload(policy, program); }),
+                        footprint);
+    ok &= PrintWorkload("Particle frames", "M particles/s",
+                        static_cast<double>(PARTICLE_FRAMES) * PARTICLES,
+                        runAll([&](auto& policy) {
+                            return RunParticleWorkload(policy, PARTICLE_FRAMES, PARTICLES);
+                        }),
+                        footprint);
+    ok &= PrintWorkload("Request loop (headers map + response)", "M requests/s", REQUESTS,
+                        runAll([&](auto& policy) { return RunRequestWorkload(policy, requests); }),
+                        footprint);
+
+    return ok ? 0 : 1;
+}
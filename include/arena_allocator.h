@@ -3,9 +3,38 @@
 #define ARENA_ALLOCATOR_H
 
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <new>
 
+#if defined(ARENA_ENABLE_SAMPLING)
+#include <atomic>
+
+namespace arena_sampling_detail {
+
+// Installed by ArenaSamplingProfiler::Start(): records one sample, returns the next countdown.
+inline std::atomic<int64_t (*)(size_t)> g_sampleHook{nullptr};
+
+// How often an idle arena re-checks whether sampling was switched on.
+inline constexpr int64_t kIdleRecheckBytes = int64_t{64} << 10;
+
+} // namespace arena_sampling_detail
+#endif
+
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+/**
+ * @brief Debug callback interface for every change to an arena's layout (see arena_occupancy.h)
+ * @note Offsets are relative to the start of the arena's block.
+ */
+class ArenaAllocationObserver {
+public:
+    virtual ~ArenaAllocationObserver() = default;
+    virtual void OnAlloc(size_t offset, size_t size, size_t align, size_t padding) = 0;
+    virtual void OnExtend(size_t offset, size_t newSize) = 0; // TryExtend() on the top allocation
+    virtual void OnRewind(size_t offset) = 0; // Reset() or ResetToMarker()
+};
+#endif
+
 /**
  * @brief Fast linear allocator for temporary allocations
  * @warning Not thread-safe. Destructors are not called on Reset().
@@ -40,10 +69,19 @@ public:
         this->m_memoryBlock = other.m_memoryBlock;
         this->m_totalSize = other.m_totalSize;
         this->m_offset = other.m_offset;
+        this->m_highWaterMark = other.m_highWaterMark;
+        this->m_resetCount = other.m_resetCount;
+#if defined(ARENA_ENABLE_SAMPLING)
+        this->m_nextSample = other.m_nextSample;
+        this->m_allocLimit = other.m_allocLimit;
+        other.m_nextSample = 0;
+        other.m_allocLimit = 0;
+#endif
 
         other.m_memoryBlock = nullptr;
         other.m_totalSize = 0;
         other.m_offset = 0;
+        other.m_highWaterMark = 0;
     }
 
     // Assign operator
@@ -53,11 +91,20 @@ public:
             this->m_memoryBlock = other.m_memoryBlock;
             this->m_totalSize = other.m_totalSize;
             this->m_offset = other.m_offset;
+            this->m_highWaterMark = other.m_highWaterMark;
+            this->m_resetCount = other.m_resetCount;
+#if defined(ARENA_ENABLE_SAMPLING)
+            this->m_nextSample = other.m_nextSample;
+            this->m_allocLimit = other.m_allocLimit;
+            other.m_nextSample = 0;
+            other.m_allocLimit = 0;
+#endif
 
             // Nullify the source pointer to prevent double-free in the source's destructor.
             other.m_memoryBlock = nullptr;
             other.m_totalSize = 0;
             other.m_offset = 0;
+            other.m_highWaterMark = 0;
         }
 
         return *this;
@@ -77,18 +124,55 @@ public:
         uintptr_t offset = currentPtr & (align - 1);
         uintptr_t padding = (offset == 0) ? 0 : (align - offset);
 
-        if (m_offset + padding + size > m_totalSize) {
+        const size_t end = m_offset + padding + size;
+        if (end > AllocLimit() && !PassLimit(end, size)) {
             return nullptr;
         }
 
         const uintptr_t nextAddress = currentPtr + padding;
-        m_offset += padding + size;
+        m_offset = end;
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+        if (m_observer) m_observer->OnAlloc(m_offset - size, size, align, padding);
+#endif
         return reinterpret_cast<void*>(nextAddress);
     }
 
+    /**
+    * @brief Resizes the most recent allocation in place
+    * @param ptr Pointer previously returned by Alloc()
+    * @return true if ptr is at the top of the arena and newSize bytes fit, false otherwise
+    */
+    [[nodiscard]] bool TryExtend(void* ptr, const size_t oldSize, const size_t newSize) {
+        const std::byte* bytes = static_cast<std::byte*>(ptr);
+
+        // Only the last allocation can be resized, since nothing lives after it yet.
+        if (bytes + oldSize != m_memoryBlock + m_offset) {
+            return false;
+        }
+
+        const size_t start = static_cast<size_t>(bytes - m_memoryBlock);
+        // Shrinking ends below m_offset, so only growth can reach the limit.
+        if (start + newSize > AllocLimit() && !PassLimit(start + newSize, newSize - oldSize)) {
+            return false;
+        }
+
+        if (newSize <= oldSize) RecordHighWaterMark();
+        m_offset = start + newSize;
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+        if (m_observer) m_observer->OnExtend(start, newSize);
+#endif
+        return true;
+    }
+
     /** @brief Resets arena to empty state (does not call destructors) */
     void Reset() {
+        RecordHighWaterMark();
+        MoveSamplePoint(0);
         m_offset = 0;
+        ++m_resetCount;
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+        if (m_observer) m_observer->OnRewind(0);
+#endif
     }
 
     /**
@@ -122,6 +206,16 @@ public:
         return static_cast<float>(m_offset) / static_cast<float>(m_totalSize);
     }
 
+    /** @brief Most bytes ever in use at once (tracked on rewind, so Alloc() pays nothing) */
+    [[nodiscard]] size_t GetHighWaterMark() const {
+        return m_offset > m_highWaterMark ? m_offset : m_highWaterMark;
+    }
+
+    /** @brief Number of Reset() calls so far, so caches can tell their memory was reclaimed */
+    [[nodiscard]] uint64_t GetResetCount() const {
+        return m_resetCount;
+    }
+
     /**
     * @brief Saves current position for partial reset
     * @see ResetToMarker()
@@ -133,12 +227,102 @@ public:
 
     /** @brief Resets arena to a previously saved marker */
     void ResetToMarker(const Marker marker) {
+        RecordHighWaterMark();
+        MoveSamplePoint(marker);
         m_offset = marker;
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+        if (m_observer) m_observer->OnRewind(marker);
+#endif
     }
 
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+    /**
+    * @brief Reports every Alloc/TryExtend/rewind to observer (nullptr detaches)
+    * @warning The observer stays with this object; it is not transferred by moves.
+    */
+    void SetObserver(ArenaAllocationObserver* observer) {
+        m_observer = observer;
+    }
+#endif
+
 private:
+    void RecordHighWaterMark() {
+        if (m_offset > m_highWaterMark) m_highWaterMark = m_offset;
+    }
+
+    // Sampling shares the bounds check of Alloc() and TryExtend(): the limit is the end of the
+    // block or the next sample point, whichever comes first, so the countdown costs nothing
+    // until it is crossed. Without ARENA_ENABLE_SAMPLING (for the whole program) this is just
+    // the block size and PassLimit() always fails.
+    [[nodiscard]] size_t AllocLimit() const {
+#if defined(ARENA_ENABLE_SAMPLING)
+        return m_allocLimit;
+#else
+        return m_totalSize;
+#endif
+    }
+
+#if defined(ARENA_ENABLE_SAMPLING)
+    // Rare slow path: false if end does not fit in the block, otherwise takes a sample (when
+    // the profiler is running) for the allocation of size bytes and sets the next sample point.
+    bool PassLimit(const size_t end, const size_t size) {
+        if (end > m_totalSize) return false;
+
+        m_nextSample = end + static_cast<size_t>(TakeSample(size));
+        m_allocLimit = m_nextSample < m_totalSize ? m_nextSample : m_totalSize;
+        return true;
+    }
+
+    // Out of line and static, so the arena never escapes into it and the compiler can keep
+    // its members in registers across Alloc() calls. Returns the bytes to the next sample.
+    [[gnu::noinline]] static int64_t TakeSample(const size_t size) {
+        using namespace arena_sampling_detail;
+        const auto hook = g_sampleHook.load(std::memory_order_acquire);
+        return hook ? hook(size) : kIdleRecheckBytes;
+    }
+#else
+    static bool PassLimit(size_t, size_t) { return false; }
+#endif
+
+    // Keeps the bytes left until the next sample when the offset is rewound.
+    void MoveSamplePoint([[maybe_unused]] const size_t newOffset) {
+#if defined(ARENA_ENABLE_SAMPLING)
+        m_nextSample = newOffset + (m_nextSample - m_offset);
+        m_allocLimit = m_nextSample < m_totalSize ? m_nextSample : m_totalSize;
+#endif
+    }
+
     std::byte* m_memoryBlock = nullptr; // Main memory buffer
     size_t m_totalSize = 0; // Total capacity
     size_t m_offset = 0; // Current allocation offset
+    size_t m_highWaterMark = 0; // Peak offset as of the last rewind
+    uint64_t m_resetCount = 0; // Reset() calls; not bumped by ResetToMarker()
+#if defined(ARENA_ENABLE_SAMPLING)
+    size_t m_nextSample = 0; // Offset of the next sample point; 0 checks in on the first Alloc()
+    size_t m_allocLimit = 0; // min(m_nextSample, m_totalSize)
+#endif
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+    ArenaAllocationObserver* m_observer = nullptr; // Debug layout tracing
+#endif
+};
+
+/**
+ * @brief RAII marker: rewinds the arena to where it was when the scope was opened
+ * @warning Like ResetToMarker(), this does not call destructors of objects in the region.
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(ArenaAllocator& arena) : m_arena(arena), m_marker(arena.GetMarker()) {}
+
+    ~ArenaScope() {
+        m_arena.ResetToMarker(m_marker);
+    }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    ArenaAllocator& m_arena;
+    ArenaAllocator::Marker m_marker;
 };
 #endif //ARENA_ALLOCATOR_H
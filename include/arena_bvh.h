@@ -0,0 +1,313 @@
+#pragma once
+#ifndef ARENA_BVH_H
+#define ARENA_BVH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <thread>
+
+#include "arena_allocator.h"
+
+/** @brief Axis-aligned bounding box */
+struct Aabb {
+    float min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                    std::numeric_limits<float>::max()};
+    float max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                    std::numeric_limits<float>::lowest()};
+
+    void Grow(const Aabb& other) {
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = std::min(min[axis], other.min[axis]);
+            max[axis] = std::max(max[axis], other.max[axis]);
+        }
+    }
+
+    void Grow(const float (&point)[3]) {
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = std::min(min[axis], point[axis]);
+            max[axis] = std::max(max[axis], point[axis]);
+        }
+    }
+
+    /** @brief Surface area; 0 for an empty box */
+    [[nodiscard]] float SurfaceArea() const {
+        const float dx = max[0] - min[0];
+        const float dy = max[1] - min[1];
+        const float dz = max[2] - min[2];
+        if (dx < 0.0f || dy < 0.0f || dz < 0.0f) return 0.0f;
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+
+    [[nodiscard]] bool Overlaps(const Aabb& other) const {
+        return min[0] <= other.max[0] && max[0] >= other.min[0] &&
+               min[1] <= other.max[1] && max[1] >= other.min[1] &&
+               min[2] <= other.max[2] && max[2] >= other.min[2];
+    }
+};
+
+/**
+ * @brief BVH node in depth-first order
+ *
+ * An internal node's left child is always the next node in the array, so only the right
+ * child index is stored; a leaf instead stores its primitive range.
+ */
+struct BvhNode {
+    Aabb bounds;
+    uint32_t rightOrFirst; // Internal: right child index. Leaf: first primIndices entry
+    uint32_t primCount; // 0 for internal nodes
+
+    [[nodiscard]] bool IsLeaf() const { return primCount != 0; }
+};
+
+/** @brief A built hierarchy; a view into arena memory valid until the arena is reset */
+struct Bvh {
+    static constexpr uint32_t kMaxDepth = 64;
+
+    const BvhNode* nodes = nullptr;
+    uint32_t nodeCount = 0;
+    const uint32_t* primIndices = nullptr; // Leaf ranges index into this, values index the input
+    uint32_t primCount = 0;
+
+    /** @brief Calls func(primitiveIndex) for every primitive whose box overlaps query */
+    template <typename Func>
+    void ForEachOverlap(const Aabb& query, const Aabb* boxes, Func func) const {
+        if (nodeCount == 0) return;
+
+        // The builder caps depth at kMaxDepth: one pending right child per ancestor, plus two.
+        uint32_t stack[kMaxDepth + 2];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const uint32_t index = stack[--top];
+            const BvhNode& node = nodes[index];
+            if (!node.bounds.Overlaps(query)) continue;
+
+            if (node.IsLeaf()) {
+                for (uint32_t i = 0; i < node.primCount; ++i) {
+                    const uint32_t prim = primIndices[node.rightOrFirst + i];
+                    if (boxes[prim].Overlaps(query)) func(prim);
+                }
+            } else {
+                stack[top++] = node.rightOrFirst;
+                stack[top++] = index + 1;
+            }
+        }
+    }
+};
+
+struct BvhBuildOptions {
+    uint32_t maxLeafPrims = 4; // Ranges larger than this are always split
+    unsigned threadCount = 1; // Rounded down to a power of two for the top-level splits
+    uint32_t minParallelPrims = 4096; // Smaller subtrees are not worth a thread
+};
+
+/**
+ * @brief Binned SAH builder whose nodes, index array and bin scratch come from an arena
+ *
+ * All arena allocation happens up front on the calling thread; worker threads only write
+ * into their preassigned regions, so the (non-thread-safe) arena is never shared.
+ * Parallel subtrees are built into reserved node ranges and then slid together, which keeps
+ * the final array in strict depth-first order.
+ */
+class BvhBuilder {
+public:
+    static constexpr uint32_t kBinCount = 16;
+
+    // Past this depth only median splits are used, which bounds the total depth by
+    // kMaxSahDepth + log2(count) <= Bvh::kMaxDepth even for adversarial SAH splits.
+    static constexpr uint32_t kMaxSahDepth = 32;
+
+    /** @throws std::bad_alloc if the arena is out of space */
+    static Bvh Build(ArenaAllocator& arena, const Aabb* boxes, const uint32_t count,
+                     const BvhBuildOptions& options = {}) {
+        if (count == 0) return {};
+
+        unsigned parallelDepth = 0;
+        while ((2u << parallelDepth) <= options.threadCount) ++parallelDepth;
+
+        // A tree with single-primitive leaves has 2N - 1 nodes; that bounds every layout.
+        auto* nodes = arena.AllocArray<BvhNode>(2 * static_cast<size_t>(count) - 1);
+        auto* primIndices = arena.AllocArray<uint32_t>(count);
+        if (!nodes || !primIndices) throw std::bad_alloc();
+
+        Context context{boxes, nodes, primIndices, nullptr, nullptr, options, parallelDepth};
+
+        ArenaScope scratch(arena);
+        context.centroids = arena.AllocArray<Centroid>(count);
+        context.bins = arena.AllocArray<BinSet>(static_cast<size_t>(1) << parallelDepth);
+        if (!context.centroids || !context.bins) throw std::bad_alloc();
+
+        for (uint32_t i = 0; i < count; ++i) {
+            primIndices[i] = i;
+            for (int axis = 0; axis < 3; ++axis) {
+                context.centroids[i].c[axis] = 0.5f * (boxes[i].min[axis] + boxes[i].max[axis]);
+            }
+        }
+
+        const uint32_t nodeCount = BuildNode(context, 0, 0, count, 0, 0, 0);
+        return Bvh{nodes, nodeCount, primIndices, count};
+    }
+
+private:
+    struct Centroid {
+        float c[3];
+    };
+
+    struct Bin {
+        Aabb bounds;
+        uint32_t count;
+    };
+
+    // One set per worker, so concurrent subtrees never share binning scratch.
+    struct BinSet {
+        Bin bins[3][kBinCount];
+    };
+
+    struct Context {
+        const Aabb* boxes;
+        BvhNode* nodes;
+        uint32_t* primIndices;
+        Centroid* centroids;
+        BinSet* bins;
+        BvhBuildOptions options;
+        unsigned parallelDepth;
+    };
+
+    struct Split {
+        int axis = -1;
+        uint32_t bin = 0;
+        float cost = std::numeric_limits<float>::max();
+    };
+
+    // Builds the subtree for primIndices[begin, end) at nodeIndex; returns one past its last node.
+    static uint32_t BuildNode(const Context& ctx, const uint32_t nodeIndex, const uint32_t begin,
+                              const uint32_t end, const uint32_t depth, const unsigned level,
+                              const unsigned worker) {
+        BvhNode& node = ctx.nodes[nodeIndex];
+        const uint32_t count = end - begin;
+
+        Aabb bounds;
+        Aabb centroidBounds;
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint32_t prim = ctx.primIndices[i];
+            bounds.Grow(ctx.boxes[prim]);
+            centroidBounds.Grow(ctx.centroids[prim].c);
+        }
+        node.bounds = bounds;
+
+        const Split split = FindSplit(ctx, begin, end, centroidBounds, ctx.bins[worker]);
+
+        // SAH leaf test: traversal cost 1 + intersecting every primitive vs. the split estimate.
+        const float leafCost = static_cast<float>(count);
+        const float splitCost = 1.0f + split.cost / std::max(bounds.SurfaceArea(), 1e-20f);
+        if (count == 1 || (count <= ctx.options.maxLeafPrims && splitCost >= leafCost)) {
+            node.rightOrFirst = begin;
+            node.primCount = count;
+            return nodeIndex + 1;
+        }
+
+        uint32_t middle = begin + count / 2;
+        if (split.axis >= 0 && depth < kMaxSahDepth) {
+            const float cmin = centroidBounds.min[split.axis];
+            const float scale = kBinCount / (centroidBounds.max[split.axis] - cmin);
+            uint32_t* pivot = std::partition(
+                ctx.primIndices + begin, ctx.primIndices + end, [&](const uint32_t prim) {
+                    return BinIndex(ctx.centroids[prim].c[split.axis], cmin, scale) <= split.bin;
+                });
+            middle = static_cast<uint32_t>(pivot - ctx.primIndices);
+        }
+        // Identical centroids (or a degenerate partition): fall back to an index median split.
+        if (middle == begin || middle == end) middle = begin + count / 2;
+
+        node.primCount = 0;
+        const uint32_t leftIndex = nodeIndex + 1;
+
+        if (level >= ctx.parallelDepth || count < ctx.options.minParallelPrims) {
+            const uint32_t leftEnd =
+                BuildNode(ctx, leftIndex, begin, middle, depth + 1, level, worker);
+            node.rightOrFirst = leftEnd;
+            return BuildNode(ctx, leftEnd, middle, end, depth + 1, level, worker);
+        }
+
+        // Parallel split: the left subtree gets its worst-case 2L - 1 node range, the right
+        // subtree starts right after it, and the two are slid together once both are done.
+        const uint32_t reservedRight = leftIndex + 2 * (middle - begin) - 1;
+        const unsigned helper = worker + (1u << level);
+        uint32_t leftEnd = 0;
+
+        std::thread leftThread([&] {
+            leftEnd = BuildNode(ctx, leftIndex, begin, middle, depth + 1, level + 1, helper);
+        });
+        const uint32_t rightEnd =
+            BuildNode(ctx, reservedRight, middle, end, depth + 1, level + 1, worker);
+        leftThread.join();
+
+        const uint32_t gap = reservedRight - leftEnd;
+        if (gap > 0) {
+            for (uint32_t i = reservedRight; i < rightEnd; ++i) {
+                BvhNode moved = ctx.nodes[i];
+                if (!moved.IsLeaf()) moved.rightOrFirst -= gap;
+                ctx.nodes[i - gap] = moved;
+            }
+        }
+
+        node.rightOrFirst = leftEnd;
+        return rightEnd - gap;
+    }
+
+    static uint32_t BinIndex(const float centroid, const float cmin, const float scale) {
+        const auto bin = static_cast<uint32_t>((centroid - cmin) * scale);
+        return std::min(bin, kBinCount - 1);
+    }
+
+    // Bins centroids along each axis and sweeps the bin boundaries for the lowest SAH cost.
+    static Split FindSplit(const Context& ctx, const uint32_t begin, const uint32_t end,
+                           const Aabb& centroidBounds, BinSet& set) {
+        Split best;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            const float cmin = centroidBounds.min[axis];
+            const float extent = centroidBounds.max[axis] - cmin;
+            if (!(extent > 0.0f)) continue;
+
+            Bin* bins = set.bins[axis];
+            for (uint32_t b = 0; b < kBinCount; ++b) bins[b] = Bin{Aabb{}, 0};
+
+            const float scale = kBinCount / extent;
+            for (uint32_t i = begin; i < end; ++i) {
+                const uint32_t prim = ctx.primIndices[i];
+                Bin& bin = bins[BinIndex(ctx.centroids[prim].c[axis], cmin, scale)];
+                bin.bounds.Grow(ctx.boxes[prim]);
+                ++bin.count;
+            }
+
+            // rightCost[b] is the cost of everything in bins (b, kBinCount).
+            float rightCost[kBinCount];
+            Aabb accumulated;
+            uint32_t accumulatedCount = 0;
+            for (uint32_t b = kBinCount - 1; b > 0; --b) {
+                accumulated.Grow(bins[b].bounds);
+                accumulatedCount += bins[b].count;
+                rightCost[b - 1] = accumulatedCount * accumulated.SurfaceArea();
+            }
+
+            accumulated = Aabb{};
+            accumulatedCount = 0;
+            for (uint32_t b = 0; b + 1 < kBinCount; ++b) {
+                accumulated.Grow(bins[b].bounds);
+                accumulatedCount += bins[b].count;
+                const float cost = accumulatedCount * accumulated.SurfaceArea() + rightCost[b];
+                if (accumulatedCount > 0 && accumulatedCount < end - begin && cost < best.cost) {
+                    best = Split{axis, b, cost};
+                }
+            }
+        }
+
+        return best;
+    }
+};
+#endif //ARENA_BVH_H
@@ -0,0 +1,167 @@
+#pragma once
+#ifndef ARENA_CSR_GRAPH_H
+#define ARENA_CSR_GRAPH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+
+#include "arena_allocator.h"
+#include "arena_parallel.h"
+#include "arena_small_vector.h"
+
+/**
+ * @brief Compressed sparse row adjacency: neighbors of v are neighbors[offsets[v], offsets[v + 1])
+ * @note A view into arena memory; it is valid until the output arena is reset.
+ */
+struct CsrGraph {
+    uint32_t nodeCount = 0;
+    uint64_t edgeCount = 0;
+    const uint64_t* offsets = nullptr; // nodeCount + 1 entries
+    const uint32_t* neighbors = nullptr; // edgeCount entries
+
+    [[nodiscard]] uint32_t Degree(const uint32_t node) const {
+        return static_cast<uint32_t>(offsets[node + 1] - offsets[node]);
+    }
+
+    [[nodiscard]] std::span<const uint32_t> Neighbors(const uint32_t node) const {
+        return {neighbors + offsets[node], neighbors + offsets[node + 1]};
+    }
+};
+
+/**
+ * @brief Builds a CsrGraph from an edge list without touching the heap
+ *
+ * Edges are ingested into the scratch arena. Build() allocates the offset and neighbor arrays
+ * contiguously in the output arena, then runs degree counting, the prefix sum and the scatter
+ * with scratch tables inside an ArenaScope on the scratch arena. Neighbor lists keep the
+ * order in which edges were added, regardless of the thread count.
+ *
+ * Scratch and output may be the same arena; the ingested edges then stay below the graph
+ * until that arena is reset. With threadCount > 1 the std::thread objects themselves are
+ * placed in scratch, but each launch still lets the runtime allocate its small start state.
+ */
+class CsrGraphBuilder {
+public:
+    struct Edge {
+        uint32_t from;
+        uint32_t to;
+    };
+
+    CsrGraphBuilder(ArenaAllocator& scratch, const uint32_t nodeCount)
+        : m_scratch(&scratch), m_nodeCount(nodeCount), m_edges(scratch) {}
+
+    /** @brief Pre-sizes the edge list so ingestion does not have to grow it */
+    void Reserve(const size_t edgeCount) { m_edges.Reserve(edgeCount); }
+
+    /**
+     * @throws std::out_of_range if from or to is not below the node count
+     * @throws std::bad_alloc if the scratch arena is out of space
+     */
+    void AddEdge(const uint32_t from, const uint32_t to) {
+        if (from >= m_nodeCount || to >= m_nodeCount) {
+            throw std::out_of_range("CsrGraphBuilder: edge endpoint out of range");
+        }
+        m_edges.PushBack(Edge{from, to});
+    }
+
+    void AddUndirectedEdge(const uint32_t a, const uint32_t b) {
+        AddEdge(a, b);
+        AddEdge(b, a);
+    }
+
+    [[nodiscard]] size_t GetEdgeCount() const { return m_edges.Size(); }
+
+    /**
+     * @param threadCount Workers for counting, prefix sum and scatter (1 = calling thread only)
+     * @throws std::bad_alloc if either arena is out of space
+     * @throws std::system_error if a worker thread cannot be started
+     */
+    CsrGraph Build(ArenaAllocator& output, unsigned threadCount = 1) {
+        using arena_parallel_detail::ParallelFor;
+        const uint64_t edgeCount = m_edges.Size();
+        if (edgeCount < threadCount) threadCount = static_cast<unsigned>(edgeCount);
+        if (threadCount == 0) threadCount = 1;
+
+        auto* offsets = output.AllocArray<uint64_t>(static_cast<size_t>(m_nodeCount) + 1);
+        auto* neighbors = output.AllocArray<uint32_t>(edgeCount);
+        if (!offsets || !neighbors) throw std::bad_alloc();
+
+        ArenaScope scope(*m_scratch);
+
+        // cursors[t * n + v]: first counts edges of thread t leaving v, then becomes the slot
+        // where thread t writes its next neighbor of v. Per-thread rows keep the scatter lock-free.
+        const size_t n = m_nodeCount;
+        auto* cursors = m_scratch->AllocArray<uint64_t>(threadCount * n);
+        auto* blockSums = m_scratch->AllocArray<uint64_t>(threadCount + 1);
+        if (!cursors || !blockSums) throw std::bad_alloc();
+
+        const Edge* edges = m_edges.Data();
+
+        // Pass 1: per-thread degree histograms over contiguous edge ranges.
+        ParallelFor(*m_scratch, threadCount, [&](const unsigned t) {
+            uint64_t* counts = cursors + t * n;
+            std::fill_n(counts, n, 0);
+
+            const auto [begin, end] = SplitRange(edgeCount, threadCount, t);
+            for (uint64_t e = begin; e < end; ++e) ++counts[edges[e].from];
+        });
+
+        // Pass 2: two-level exclusive scan. Each thread sums a node range, the block totals
+        // are scanned serially (threadCount values), then each thread finishes its range.
+        ParallelFor(*m_scratch, threadCount, [&](const unsigned t) {
+            const auto [begin, end] = SplitRange(n, threadCount, t);
+            uint64_t sum = 0;
+            for (size_t v = begin; v < end; ++v) {
+                for (unsigned w = 0; w < threadCount; ++w) sum += cursors[w * n + v];
+            }
+            blockSums[t + 1] = sum;
+        });
+
+        blockSums[0] = 0;
+        for (unsigned t = 0; t < threadCount; ++t) blockSums[t + 1] += blockSums[t];
+
+        ParallelFor(*m_scratch, threadCount, [&](const unsigned t) {
+            const auto [begin, end] = SplitRange(n, threadCount, t);
+            uint64_t running = blockSums[t];
+            for (size_t v = begin; v < end; ++v) {
+                offsets[v] = running;
+                for (unsigned w = 0; w < threadCount; ++w) {
+                    const uint64_t count = cursors[w * n + v];
+                    cursors[w * n + v] = running;
+                    running += count;
+                }
+            }
+        });
+        offsets[n] = edgeCount;
+
+        // Pass 3: scatter. Thread t owns the slots its earlier edges were counted into.
+        ParallelFor(*m_scratch, threadCount, [&](const unsigned t) {
+            uint64_t* slots = cursors + t * n;
+
+            const auto [begin, end] = SplitRange(edgeCount, threadCount, t);
+            for (uint64_t e = begin; e < end; ++e) neighbors[slots[edges[e].from]++] = edges[e].to;
+        });
+
+        return CsrGraph{m_nodeCount, edgeCount, offsets, neighbors};
+    }
+
+private:
+    struct Range {
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    static Range SplitRange(const uint64_t count, const unsigned parts, const unsigned index) {
+        return {count * index / parts, count * (index + 1) / parts};
+    }
+
+    ArenaAllocator* m_scratch; // Edge list and build temporaries
+    uint32_t m_nodeCount;
+    ArenaSmallVector<Edge, 16> m_edges; // Grows in place at the top of scratch
+};
+#endif //ARENA_CSR_GRAPH_H
@@ -0,0 +1,244 @@
+#pragma once
+#ifndef ARENA_DEQUE_H
+#define ARENA_DEQUE_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Double-ended queue made of fixed-size segments allocated from an ArenaAllocator
+ *
+ * Segments form a doubly linked list, so unlike std::deque there is no block map to
+ * reallocate and elements are never copied on growth. Drained segments go to an internal
+ * free list and are reused before the arena is asked for more memory.
+ *
+ * @warning Segment memory is only reclaimed by the arena's Reset()/ResetToMarker().
+ */
+template <typename T, size_t SegmentSize = 64>
+class ArenaDeque {
+    static_assert(SegmentSize > 0, "ArenaDeque segments must hold at least one element");
+
+    struct Segment {
+        Segment* prev;
+        Segment* next;
+        alignas(T) std::byte storage[SegmentSize * sizeof(T)];
+
+        T* Slot(const size_t index) {
+            return std::launder(reinterpret_cast<T*>(storage)) + index;
+        }
+    };
+
+public:
+    /** @brief Forward iterator from front to back */
+    class Iterator {
+    public:
+        Iterator(Segment* segment, const size_t index) : m_segment(segment), m_index(index) {}
+
+        T& operator*() const { return *m_segment->Slot(m_index); }
+        T* operator->() const { return m_segment->Slot(m_index); }
+
+        Iterator& operator++() {
+            // Hop to the next segment, except on the tail where SegmentSize is a valid end().
+            if (++m_index == SegmentSize && m_segment->next) {
+                m_segment = m_segment->next;
+                m_index = 0;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return m_segment == other.m_segment && m_index == other.m_index;
+        }
+
+    private:
+        Segment* m_segment;
+        size_t m_index;
+    };
+
+    explicit ArenaDeque(ArenaAllocator& arena) : m_arena(&arena) {}
+
+    ~ArenaDeque() {
+        DestroyElements();
+    }
+
+    ArenaDeque(const ArenaDeque&) = delete;
+    ArenaDeque& operator=(const ArenaDeque&) = delete;
+
+    /** @throws std::bad_alloc if a new segment is needed and the arena is out of space */
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (m_tail && m_tailIndex < SegmentSize) {
+            T* slot = new (m_tail->Slot(m_tailIndex)) T(std::forward<Args>(args)...);
+            ++m_tailIndex;
+            ++m_size;
+            return *slot;
+        }
+
+        Segment* segment = AcquireSegment();
+        T* slot = ConstructInto(segment, 0, std::forward<Args>(args)...);
+        if (m_tail) {
+            segment->prev = m_tail;
+            m_tail->next = segment;
+        } else {
+            m_head = segment;
+            m_headIndex = 0;
+        }
+        m_tail = segment;
+        m_tailIndex = 1;
+        ++m_size;
+        return *slot;
+    }
+
+    /** @throws std::bad_alloc if a new segment is needed and the arena is out of space */
+    template <typename... Args>
+    T& EmplaceFront(Args&&... args) {
+        if (m_head && m_headIndex > 0) {
+            T* slot = new (m_head->Slot(m_headIndex - 1)) T(std::forward<Args>(args)...);
+            --m_headIndex;
+            ++m_size;
+            return *slot;
+        }
+
+        Segment* segment = AcquireSegment();
+        T* slot = ConstructInto(segment, SegmentSize - 1, std::forward<Args>(args)...);
+        if (m_head) {
+            segment->next = m_head;
+            m_head->prev = segment;
+        } else {
+            m_tail = segment;
+            m_tailIndex = SegmentSize;
+        }
+        m_head = segment;
+        m_headIndex = SegmentSize - 1;
+        ++m_size;
+        return *slot;
+    }
+
+    void PushBack(const T& value) { EmplaceBack(value); }
+    void PushBack(T&& value) { EmplaceBack(std::move(value)); }
+    void PushFront(const T& value) { EmplaceFront(value); }
+    void PushFront(T&& value) { EmplaceFront(std::move(value)); }
+
+    void PopFront() {
+        std::destroy_at(m_head->Slot(m_headIndex));
+        ++m_headIndex;
+        --m_size;
+
+        if (m_size == 0) {
+            ReleaseAll();
+        } else if (m_headIndex == SegmentSize) {
+            Segment* drained = m_head;
+            m_head = m_head->next;
+            m_head->prev = nullptr;
+            m_headIndex = 0;
+            RecycleSegment(drained);
+        }
+    }
+
+    void PopBack() {
+        --m_tailIndex;
+        std::destroy_at(m_tail->Slot(m_tailIndex));
+        --m_size;
+
+        if (m_size == 0) {
+            ReleaseAll();
+        } else if (m_tailIndex == 0) {
+            Segment* drained = m_tail;
+            m_tail = m_tail->prev;
+            m_tail->next = nullptr;
+            m_tailIndex = SegmentSize;
+            RecycleSegment(drained);
+        }
+    }
+
+    /** @brief Destroys all elements and moves every segment to the free list */
+    void Clear() {
+        DestroyElements();
+        ReleaseAll();
+    }
+
+    T& Front() { return *m_head->Slot(m_headIndex); }
+    const T& Front() const { return *m_head->Slot(m_headIndex); }
+    T& Back() { return *m_tail->Slot(m_tailIndex - 1); }
+    const T& Back() const { return *m_tail->Slot(m_tailIndex - 1); }
+
+    Iterator begin() const { return Iterator(m_head, m_headIndex); }
+    Iterator end() const { return Iterator(m_tail, m_tailIndex); }
+
+    [[nodiscard]] size_t Size() const { return m_size; }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+    /** @brief Number of drained segments waiting to be reused */
+    [[nodiscard]] size_t GetFreeSegmentCount() const {
+        size_t count = 0;
+        for (const Segment* segment = m_freeList; segment; segment = segment->next) {
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    Segment* AcquireSegment() {
+        Segment* segment = m_freeList;
+
+        if (segment) {
+            m_freeList = segment->next;
+        } else {
+            // Raw Alloc instead of New<Segment>() so the element storage is not zero-filled.
+            segment = static_cast<Segment*>(m_arena->Alloc(sizeof(Segment), alignof(Segment)));
+            if (!segment) throw std::bad_alloc();
+        }
+
+        segment->prev = nullptr;
+        segment->next = nullptr;
+        return segment;
+    }
+
+    void RecycleSegment(Segment* segment) {
+        segment->next = m_freeList;
+        m_freeList = segment;
+    }
+
+    // Builds the first element of a segment that is not linked in yet, so that a throwing
+    // constructor leaves the deque exactly as it was (the segment goes back to the free list).
+    template <typename... Args>
+    T* ConstructInto(Segment* segment, const size_t index, Args&&... args) {
+        try {
+            return new (segment->Slot(index)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            RecycleSegment(segment);
+            throw;
+        }
+    }
+
+    void DestroyElements() {
+        for (T& value : *this) {
+            std::destroy_at(&value);
+        }
+        m_size = 0;
+    }
+
+    void ReleaseAll() {
+        while (m_head) {
+            Segment* next = m_head->next;
+            RecycleSegment(m_head);
+            m_head = next;
+        }
+
+        m_tail = nullptr;
+        m_headIndex = m_tailIndex = 0;
+    }
+
+    ArenaAllocator* m_arena; // Segment source
+    Segment* m_head = nullptr; // Segment holding Front()
+    Segment* m_tail = nullptr; // Segment holding Back()
+    size_t m_headIndex = 0; // Index of Front() inside m_head
+    size_t m_tailIndex = 0; // One past Back() inside m_tail
+    size_t m_size = 0; // Element count
+    Segment* m_freeList = nullptr; // Drained segments, linked through next
+};
+#endif //ARENA_DEQUE_H
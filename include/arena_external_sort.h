@@ -0,0 +1,384 @@
+#pragma once
+#ifndef ARENA_EXTERNAL_SORT_H
+#define ARENA_EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#define ARENA_EXTERNAL_SORT_POSIX 1
+#endif
+
+#include "arena_allocator.h"
+
+namespace arena_external_sort_detail {
+
+constexpr size_t kMaxIoBytes = size_t{1} << 30; // Per read/write call
+constexpr size_t kMinReadBytes = 64 * 1024; // Smallest useful merge read buffer
+
+// Unlinked temp file: in directory if given, else wherever std::tmpfile() puts it.
+inline std::FILE* OpenSpillFile(const char* directory) {
+#ifdef ARENA_EXTERNAL_SORT_POSIX
+    if (directory) {
+        std::string path = std::string(directory) + "/arena_sort_XXXXXX";
+        const int fd = mkstemp(path.data());
+        if (fd < 0) return nullptr;
+        unlink(path.c_str()); // Space is returned when the file is closed, even on a crash
+        std::FILE* file = fdopen(fd, "w+b");
+        if (!file) close(fd);
+        return file;
+    }
+#else
+    (void)directory;
+#endif
+    return std::tmpfile();
+}
+
+#ifndef ARENA_EXTERNAL_SORT_POSIX
+// Fallback seek for the stdio path; fseek() takes a long, which is 32 bits on Windows.
+inline bool SeekTo(std::FILE* file, const uint64_t offset) {
+#if defined(_WIN32)
+    return offset <= static_cast<uint64_t>(INT64_MAX) &&
+           _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return offset <= static_cast<uint64_t>(LONG_MAX) &&
+           std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+#endif
+}
+#endif
+
+inline bool WriteAt(std::FILE* file, uint64_t offset, const void* data, size_t bytes) {
+    const auto* cursor = static_cast<const char*>(data);
+#ifdef ARENA_EXTERNAL_SORT_POSIX
+    const int fd = fileno(file);
+    while (bytes > 0) {
+        const ssize_t written = pwrite(fd, cursor, std::min(bytes, kMaxIoBytes),
+                                       static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        cursor += written;
+        offset += static_cast<uint64_t>(written);
+        bytes -= static_cast<size_t>(written);
+    }
+    return true;
+#else
+    return SeekTo(file, offset) && std::fwrite(cursor, 1, bytes, file) == bytes;
+#endif
+}
+
+inline bool ReadAt(std::FILE* file, uint64_t offset, void* data, size_t bytes) {
+    auto* cursor = static_cast<char*>(data);
+#ifdef ARENA_EXTERNAL_SORT_POSIX
+    const int fd = fileno(file);
+    while (bytes > 0) {
+        const ssize_t read = pread(fd, cursor, std::min(bytes, kMaxIoBytes),
+                                   static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR) continue;
+        if (read <= 0) return false;
+        cursor += read;
+        offset += static_cast<uint64_t>(read);
+        bytes -= static_cast<size_t>(read);
+    }
+    return true;
+#else
+    return SeekTo(file, offset) && std::fread(cursor, 1, bytes, file) == bytes;
+#endif
+}
+
+// Asks the kernel to start reading the range now, so the next refill finds it cached.
+inline void ReadAhead([[maybe_unused]] std::FILE* file, [[maybe_unused]] const uint64_t offset,
+                      [[maybe_unused]] const size_t bytes) {
+#if defined(ARENA_EXTERNAL_SORT_POSIX) && defined(POSIX_FADV_WILLNEED)
+    if (bytes) {
+        posix_fadvise(fileno(file), static_cast<off_t>(offset), static_cast<off_t>(bytes),
+                      POSIX_FADV_WILLNEED);
+    }
+#endif
+}
+
+} // namespace arena_external_sort_detail
+
+/**
+ * @brief Sorts more records than fit in memory, using one arena as its whole memory budget
+ *
+ * Push() fills the free part of the arena with a run. A full run is sorted in place and
+ * written to an unlinked temp file with one large sequential write, and the arena is reused
+ * for the next run. Finish() splits the arena into one read buffer per run and streams a
+ * k-way merge to a sink; each refill reads a whole buffer and hints the kernel to read the
+ * run's next buffer ahead. When there are too many runs for useful buffers, groups of runs
+ * are first merged into longer ones. Input that fits in one run never touches the disk.
+ *
+ * Memory use is the arena, whatever the input size. The temp file holds the input once, plus
+ * once more for each extra merge pass. Errors from the temp file throw std::runtime_error.
+ * @warning The sorter claims all free space in the arena from construction until it is
+ *          destroyed, when it rewinds the arena; do not allocate from the arena meanwhile.
+ */
+template <typename T, typename Less = std::less<T>>
+class ArenaExternalSorter {
+    static_assert(std::is_trivially_copyable_v<T>, "Records are spilled as raw bytes");
+
+public:
+    /**
+     * @param spillDirectory Directory for the temp file (POSIX); nullptr uses std::tmpfile()
+     * @throws std::invalid_argument if the arena has less than 64 KiB (or 4 records) free
+     */
+    explicit ArenaExternalSorter(ArenaAllocator& arena, const char* spillDirectory = nullptr,
+                                 Less less = Less{})
+        : m_arena(&arena), m_marker(arena.GetMarker()), m_spillDirectory(spillDirectory),
+          m_less(less) {
+        using namespace arena_external_sort_detail;
+        m_budget = FreeRecords();
+        // Size check before claiming the arena: the destructor does not run if this throws
+        if (m_budget < 4 || m_budget * sizeof(T) < kMinReadBytes) {
+            throw std::invalid_argument("ArenaExternalSorter: arena too small for a run");
+        }
+        m_run = arena.AllocArray<T>(m_budget);
+        if (!m_run) throw std::invalid_argument("ArenaExternalSorter: arena too small for a run");
+    }
+
+    ~ArenaExternalSorter() {
+        if (m_file) std::fclose(m_file);
+        m_arena->ResetToMarker(m_marker);
+    }
+
+    ArenaExternalSorter(const ArenaExternalSorter&) = delete;
+    ArenaExternalSorter& operator=(const ArenaExternalSorter&) = delete;
+
+    /** @throws std::runtime_error if a full run cannot be spilled */
+    void Push(const T& value) {
+        if (m_runSize == m_budget) SpillRun();
+        m_run[m_runSize++] = value;
+    }
+
+    void Push(const std::span<const T> values) {
+        for (size_t done = 0; done < values.size();) {
+            if (m_runSize == m_budget) SpillRun();
+            const size_t count = std::min(values.size() - done, m_budget - m_runSize);
+            std::memcpy(m_run + m_runSize, values.data() + done, count * sizeof(T));
+            m_runSize += count;
+            done += count;
+        }
+    }
+
+    /**
+     * @brief Calls sink(const T&) for every pushed record in sorted order, then empties
+     * @throws std::runtime_error on a temp file error
+     * @note If sink (or the temp file) throws, the remaining records are dropped and the
+     *       sorter is left empty and ready for new input.
+     */
+    template <typename Sink>
+    void Finish(Sink sink) {
+        try {
+            std::sort(m_run, m_run + m_runSize, m_less);
+            if (m_runs.empty()) {
+                for (size_t i = 0; i < m_runSize; ++i) sink(m_run[i]);
+            } else {
+                if (m_runSize) WriteRun(m_run, m_runSize);
+                MergeAll(sink);
+            }
+        } catch (...) {
+            // MergeAll() has handed the run's arena space to read buffers; start over.
+            Restart();
+            throw;
+        }
+        Restart();
+    }
+
+    /** @brief Records per in-memory run */
+    [[nodiscard]] size_t GetRunCapacity() const { return m_budget; }
+
+    /** @brief Sorted runs written to disk so far (0 while all input has fit in memory) */
+    [[nodiscard]] size_t GetRunCount() const { return m_runCount; }
+
+    /** @brief Bytes written to the temp file in total, including intermediate merges */
+    [[nodiscard]] uint64_t GetSpilledBytes() const { return m_spilledBytes; }
+
+private:
+    struct Run {
+        uint64_t offset; // Byte offset in the temp file
+        uint64_t count;
+    };
+
+    struct Reader {
+        uint64_t next; // File offset of the next unread record
+        uint64_t end;
+        T* buffer;
+        size_t capacity; // Records buffer can hold
+        size_t position;
+        size_t count; // Records in buffer
+    };
+
+    // Drops all input and claims the arena for a fresh run.
+    void Restart() {
+        m_runSize = 0;
+        m_runs.clear();
+        m_fileEnd = 0;
+        if (m_file) std::fclose(m_file);
+        m_file = nullptr;
+        m_arena->ResetToMarker(m_marker);
+        m_run = m_arena->AllocArray<T>(m_budget); // Fit before, so fits again
+    }
+
+    void SpillRun() {
+        std::sort(m_run, m_run + m_runSize, m_less);
+        WriteRun(m_run, m_runSize);
+        m_runSize = 0;
+    }
+
+    void WriteRun(const T* records, const size_t count) {
+        const uint64_t offset = Append(records, count);
+        m_runs.push_back({offset, count});
+        ++m_runCount;
+    }
+
+    uint64_t Append(const T* records, const size_t count) {
+        using namespace arena_external_sort_detail;
+        if (!m_file) {
+            m_file = OpenSpillFile(m_spillDirectory);
+            if (!m_file) throw std::runtime_error("ArenaExternalSorter: cannot create temp file");
+        }
+        const uint64_t offset = m_fileEnd;
+        if (!WriteAt(m_file, offset, records, count * sizeof(T))) {
+            throw std::runtime_error("ArenaExternalSorter: temp file write failed");
+        }
+        m_fileEnd += count * sizeof(T);
+        m_spilledBytes += count * sizeof(T);
+        return offset;
+    }
+
+    template <typename Sink>
+    void MergeAll(Sink& sink) {
+        using namespace arena_external_sort_detail;
+        m_arena->ResetToMarker(m_marker); // Every run is on disk now
+
+        // Runs to merge at once, so each read buffer (and the output buffer of an
+        // intermediate pass) still gets at least kMinReadBytes.
+        const size_t fanIn =
+            std::max<size_t>(2, m_budget * sizeof(T) / std::max(kMinReadBytes, sizeof(T)) - 1);
+        size_t first = 0;
+        for (; m_runs.size() - first > fanIn; first += fanIn) {
+            ArenaScope pass(*m_arena);
+            const size_t outputCapacity = m_budget / (fanIn + 1);
+            T* output = m_arena->AllocArray<T>(outputCapacity);
+            if (!output) throw std::bad_alloc();
+
+            const uint64_t offset = m_fileEnd;
+            uint64_t count = 0;
+            size_t buffered = 0;
+            auto write = [&](const T& value) {
+                output[buffered++] = value;
+                if (buffered == outputCapacity) {
+                    Append(output, buffered);
+                    count += buffered;
+                    buffered = 0;
+                }
+            };
+            Merge(first, first + fanIn, write);
+            Append(output, buffered);
+            m_runs.push_back({offset, count + buffered});
+        }
+        Merge(first, m_runs.size(), sink);
+    }
+
+    // Streams the merge of runs [first, last) to sink, sharing the arena's free space
+    // between their read buffers.
+    template <typename Sink>
+    void Merge(const size_t first, const size_t last, Sink& sink) {
+        ArenaScope scope(*m_arena);
+        const size_t runCount = last - first;
+        auto* readers = m_arena->AllocArray<Reader>(runCount);
+        auto* heap = m_arena->AllocArray<uint32_t>(runCount);
+        const size_t bufferRecords = FreeRecords() / runCount;
+        if (!readers || !heap || bufferRecords == 0) throw std::bad_alloc();
+
+        size_t heapSize = 0;
+        for (size_t r = 0; r < runCount; ++r) {
+            const Run& run = m_runs[first + r];
+            T* buffer = m_arena->AllocArray<T>(bufferRecords);
+            if (!buffer) throw std::bad_alloc();
+            readers[r] = {run.offset, run.offset + run.count * sizeof(T), buffer, bufferRecords,
+                          0, 0};
+            if (Refill(readers[r])) heap[heapSize++] = static_cast<uint32_t>(r);
+        }
+
+        // Min-heap of readers by their current record. The top is replaced in place after each
+        // record, so most steps cost one sift-down.
+        const auto before = [&](const uint32_t a, const uint32_t b) {
+            return m_less(readers[a].buffer[readers[a].position],
+                          readers[b].buffer[readers[b].position]);
+        };
+        const auto siftDown = [&](size_t node) {
+            const uint32_t moving = heap[node];
+            for (size_t child = 2 * node + 1; child < heapSize; child = 2 * node + 1) {
+                if (child + 1 < heapSize && before(heap[child + 1], heap[child])) ++child;
+                if (!before(heap[child], moving)) break;
+                heap[node] = heap[child];
+                node = child;
+            }
+            heap[node] = moving;
+        };
+        for (size_t node = heapSize / 2; node-- > 0;) siftDown(node);
+
+        while (heapSize > 0) {
+            Reader& reader = readers[heap[0]];
+            sink(reader.buffer[reader.position]);
+            if (++reader.position == reader.count && !Refill(reader)) heap[0] = heap[--heapSize];
+            siftDown(0);
+        }
+    }
+
+    // Reads the reader's next buffer and starts the read of the one after; false at run end.
+    bool Refill(Reader& reader) {
+        using namespace arena_external_sort_detail;
+        if (reader.next == reader.end) return false;
+
+        const size_t bufferBytes = reader.capacity * sizeof(T);
+        const auto bytes = static_cast<size_t>(std::min<uint64_t>(reader.end - reader.next,
+                                                                  bufferBytes));
+        if (!ReadAt(m_file, reader.next, reader.buffer, bytes)) {
+            throw std::runtime_error("ArenaExternalSorter: temp file read failed");
+        }
+        reader.next += bytes;
+        reader.position = 0;
+        reader.count = bytes / sizeof(T);
+        ReadAhead(m_file, reader.next,
+                  static_cast<size_t>(std::min<uint64_t>(reader.end - reader.next, bufferBytes)));
+        return true;
+    }
+
+    // Records that fit in the arena's free space, keeping room for alignment padding.
+    size_t FreeRecords() const {
+        const size_t records = (m_arena->GetTotalSize() - m_arena->GetUsedMemory()) / sizeof(T);
+        return records ? records - 1 : 0;
+    }
+
+    ArenaAllocator* m_arena;
+    ArenaAllocator::Marker m_marker; // Arena position to rewind to between phases
+    const char* m_spillDirectory;
+    Less m_less;
+    T* m_run = nullptr; // Current run, m_budget records from the free part of the arena
+    size_t m_budget = 0;
+    size_t m_runSize = 0;
+    std::vector<Run> m_runs; // Runs of the current sort, in file order
+    size_t m_runCount = 0;
+    std::FILE* m_file = nullptr; // Unlinked temp file, created on the first spill
+    uint64_t m_fileEnd = 0;
+    uint64_t m_spilledBytes = 0;
+};
+#endif //ARENA_EXTERNAL_SORT_H
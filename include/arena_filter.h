@@ -0,0 +1,337 @@
+#pragma once
+#ifndef ARENA_FILTER_H
+#define ARENA_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ARENA_FILTER_AVX2 1
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ARENA_FILTER_SSE2 1
+#endif
+
+#include "arena_allocator.h"
+
+namespace arena_filter_detail {
+
+inline uint64_t Mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Maps a 32-bit hash onto [0, range) without a division.
+inline uint32_t FastRange(const uint32_t hash, const uint32_t range) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(hash) * range) >> 32);
+}
+
+inline size_t RoundUpToPowerOfTwo(const size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+// Odd multipliers, one per 64-bit lane of a Bloom block (from the Parquet split block filter).
+alignas(32) inline constexpr uint32_t kBloomSalts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                                        0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                                        0x9efc4947U, 0x5c6bfb31U};
+
+} // namespace arena_filter_detail
+
+/**
+ * @brief Blocked Bloom filter whose bit array lives in an ArenaAllocator
+ *
+ * Each key maps to one 64-byte block (a cache line) and sets one bit in each of its eight
+ * 64-bit lanes, so a probe touches a single line and is checked with a few vector
+ * instructions. Keys are 64-bit values; hash other keys to 64 bits first.
+ *
+ * There are no false negatives. At the default 10 bits per key the false positive rate is
+ * about 1%; 16 bits per key gives about 0.1%.
+ * @warning The filter is a view into arena memory: it becomes invalid when the arena is reset
+ * or rewound below the marker taken before construction. That is the intended way to drop
+ * a per-batch filter.
+ */
+class ArenaBloomFilter {
+public:
+    static constexpr size_t kBlockBytes = 64;
+
+    /**
+     * @brief Sizes the filter for expectedCount keys and clears it
+     * @throws std::bad_alloc if the arena cannot hold the bit array
+     */
+    ArenaBloomFilter(ArenaAllocator& arena, const size_t expectedCount,
+                     const size_t bitsPerKey = 10) {
+        const size_t bits = (expectedCount ? expectedCount : 1) * (bitsPerKey ? bitsPerKey : 1);
+        m_blockCount = static_cast<uint32_t>((bits + kBlockBytes * 8 - 1) / (kBlockBytes * 8));
+        m_blocks = static_cast<Block*>(arena.Alloc(GetMemoryBytes(), kBlockBytes));
+        if (!m_blocks) throw std::bad_alloc();
+        Clear();
+    }
+
+    void Insert(const uint64_t key) {
+        const uint64_t hash = arena_filter_detail::Mix64(key);
+        Block& block = m_blocks[BlockIndex(hash)];
+        uint64_t masks[8];
+        MakeMasks(static_cast<uint32_t>(hash), masks);
+        for (int lane = 0; lane < 8; ++lane) block.lanes[lane] |= masks[lane];
+    }
+
+    /** @return false if key was never inserted; true if it probably was */
+    [[nodiscard]] bool MayContain(const uint64_t key) const {
+        const uint64_t hash = arena_filter_detail::Mix64(key);
+        const Block& block = m_blocks[BlockIndex(hash)];
+#if defined(ARENA_FILTER_AVX2)
+        // Build all eight lane masks at once, then test (block & mask) == mask per half line.
+        const __m256i salts =
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(arena_filter_detail::kBloomSalts));
+        const __m256i products =
+            _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts);
+        const __m256i shifts = _mm256_srli_epi32(products, 26);
+        const __m256i one = _mm256_set1_epi64x(1);
+        const __m256i lowMasks =
+            _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shifts)));
+        const __m256i highMasks =
+            _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shifts, 1)));
+        const __m256i* lanes = reinterpret_cast<const __m256i*>(block.lanes);
+        return _mm256_testc_si256(_mm256_load_si256(lanes), lowMasks) &&
+               _mm256_testc_si256(_mm256_load_si256(lanes + 1), highMasks);
+#elif defined(ARENA_FILTER_SSE2)
+        uint64_t masks[8];
+        MakeMasks(static_cast<uint32_t>(hash), masks);
+        // One AND-compare per 16 bytes; every 32-bit half of every lane must match its mask.
+        const __m128i* lanes = reinterpret_cast<const __m128i*>(block.lanes);
+        const __m128i* wanted = reinterpret_cast<const __m128i*>(masks);
+        __m128i allSet = _mm_set1_epi32(-1);
+        for (int i = 0; i < 4; ++i) {
+            const __m128i mask = _mm_loadu_si128(wanted + i);
+            const __m128i present = _mm_and_si128(_mm_load_si128(lanes + i), mask);
+            allSet = _mm_and_si128(allSet, _mm_cmpeq_epi32(present, mask));
+        }
+        return _mm_movemask_epi8(allSet) == 0xFFFF;
+#else
+        uint64_t masks[8];
+        MakeMasks(static_cast<uint32_t>(hash), masks);
+        uint64_t missing = 0;
+        for (int lane = 0; lane < 8; ++lane) missing |= masks[lane] & ~block.lanes[lane];
+        return missing == 0;
+#endif
+    }
+
+    /** @brief Removes every key; the bit array is reused */
+    void Clear() { std::memset(m_blocks, 0, GetMemoryBytes()); }
+
+    [[nodiscard]] size_t GetBlockCount() const { return m_blockCount; }
+    [[nodiscard]] size_t GetMemoryBytes() const { return m_blockCount * kBlockBytes; }
+
+private:
+    struct alignas(kBlockBytes) Block {
+        uint64_t lanes[8];
+    };
+
+    [[nodiscard]] uint32_t BlockIndex(const uint64_t hash) const {
+        return arena_filter_detail::FastRange(static_cast<uint32_t>(hash >> 32), m_blockCount);
+    }
+
+    // Lane i gets the bit chosen by the top 6 bits of hash * salt[i].
+    static void MakeMasks(const uint32_t hash, uint64_t (&masks)[8]) {
+        for (int lane = 0; lane < 8; ++lane) {
+            masks[lane] = uint64_t{1} << ((hash * arena_filter_detail::kBloomSalts[lane]) >> 26);
+        }
+    }
+
+    Block* m_blocks = nullptr; // Arena memory, 64-byte aligned
+    uint32_t m_blockCount = 0;
+};
+
+/**
+ * @brief Cuckoo filter with 16-bit fingerprints whose buckets live in an ArenaAllocator
+ *
+ * Each key has two candidate buckets of four fingerprints (8 bytes each); a lookup compares
+ * its fingerprint against all eight slots with one vector compare. Unlike a Bloom filter it
+ * supports Erase() of previously inserted keys, at a false positive rate of about 0.01%.
+ * Keys are 64-bit values; hash other keys to 64 bits first.
+ *
+ * The table is sized for expectedCount keys at 95% load. Once a kick-out chain fails, the
+ * homeless fingerprint is kept in a one-entry stash and further inserts return false.
+ * @warning Like ArenaBloomFilter, the filter is invalid once the arena is reset or rewound
+ * below the marker taken before construction.
+ */
+class ArenaCuckooFilter {
+public:
+    static constexpr size_t kSlotsPerBucket = 4;
+    static constexpr int kMaxKicks = 500;
+
+    /**
+     * @brief Sizes the filter for expectedCount keys and clears it
+     * @throws std::bad_alloc if the arena cannot hold the buckets
+     */
+    ArenaCuckooFilter(ArenaAllocator& arena, const size_t expectedCount) {
+        const size_t wanted = (expectedCount * 100 / 95 + kSlotsPerBucket) / kSlotsPerBucket;
+        const size_t bucketCount =
+            arena_filter_detail::RoundUpToPowerOfTwo(wanted < 2 ? 2 : wanted);
+        m_bucketMask = static_cast<uint32_t>(bucketCount - 1);
+        m_buckets = static_cast<Bucket*>(arena.Alloc(GetMemoryBytes(), 64));
+        if (!m_buckets) throw std::bad_alloc();
+        Clear();
+    }
+
+    /** @return false if the filter is full and the key was not added */
+    bool Insert(const uint64_t key) {
+        if (m_stashFingerprint != 0) return false;
+
+        const uint64_t hash = arena_filter_detail::Mix64(key);
+        uint16_t fingerprint = Fingerprint(hash);
+        uint32_t bucket = static_cast<uint32_t>(hash) & m_bucketMask;
+        if (TryPlace(bucket, fingerprint) ||
+            TryPlace(AltBucket(bucket, fingerprint), fingerprint)) {
+            ++m_size;
+            return true;
+        }
+
+        // Evict a pseudo-random resident and move it to its other bucket, up to kMaxKicks times.
+        uint32_t victimSlot = static_cast<uint32_t>(hash >> 32);
+        for (int kick = 0; kick < kMaxKicks; ++kick) {
+            victimSlot = victimSlot * 1103515245u + 12345u;
+            uint16_t& slot = m_buckets[bucket].slots[(victimSlot >> 16) % kSlotsPerBucket];
+            const uint16_t evicted = slot;
+            slot = fingerprint;
+            fingerprint = evicted;
+            bucket = AltBucket(bucket, fingerprint);
+            if (TryPlace(bucket, fingerprint)) {
+                ++m_size;
+                return true;
+            }
+        }
+
+        m_stashFingerprint = fingerprint;
+        m_stashBucket = bucket;
+        ++m_size;
+        return true;
+    }
+
+    /** @return false if key was never inserted (or was erased); true if it probably was */
+    [[nodiscard]] bool MayContain(const uint64_t key) const {
+        const uint64_t hash = arena_filter_detail::Mix64(key);
+        const uint16_t fingerprint = Fingerprint(hash);
+        const uint32_t first = static_cast<uint32_t>(hash) & m_bucketMask;
+        const uint32_t second = AltBucket(first, fingerprint);
+
+        if (m_stashFingerprint == fingerprint &&
+            (m_stashBucket == first || m_stashBucket == second)) {
+            return true;
+        }
+
+#if defined(ARENA_FILTER_SSE2)
+        // Both buckets in one register: eight 16-bit slots against the broadcast fingerprint.
+        const __m128i slots = _mm_unpacklo_epi64(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(m_buckets[first].slots)),
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(m_buckets[second].slots)));
+        const __m128i match =
+            _mm_cmpeq_epi16(slots, _mm_set1_epi16(static_cast<short>(fingerprint)));
+        return _mm_movemask_epi8(match) != 0;
+#else
+        for (const uint16_t slot : m_buckets[first].slots) {
+            if (slot == fingerprint) return true;
+        }
+        for (const uint16_t slot : m_buckets[second].slots) {
+            if (slot == fingerprint) return true;
+        }
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Removes one copy of a previously inserted key
+     * @warning Erasing a key that was never inserted can remove another key's fingerprint.
+     * @return false if no matching fingerprint was found
+     */
+    bool Erase(const uint64_t key) {
+        const uint64_t hash = arena_filter_detail::Mix64(key);
+        const uint16_t fingerprint = Fingerprint(hash);
+        const uint32_t first = static_cast<uint32_t>(hash) & m_bucketMask;
+        const uint32_t second = AltBucket(first, fingerprint);
+
+        if (!EraseFrom(first, fingerprint) && !EraseFrom(second, fingerprint)) {
+            if (m_stashFingerprint != fingerprint ||
+                (m_stashBucket != first && m_stashBucket != second)) {
+                return false;
+            }
+            m_stashFingerprint = 0;
+            --m_size;
+            return true;
+        }
+        --m_size;
+
+        // Room was made: give the stashed fingerprint its slot back.
+        if (m_stashFingerprint != 0 && TryPlace(m_stashBucket, m_stashFingerprint)) {
+            m_stashFingerprint = 0;
+        }
+        return true;
+    }
+
+    /** @brief Removes every key; the buckets are reused */
+    void Clear() {
+        std::memset(m_buckets, 0, GetMemoryBytes());
+        m_size = 0;
+        m_stashFingerprint = 0;
+        m_stashBucket = 0;
+    }
+
+    [[nodiscard]] size_t Size() const { return m_size; }
+    [[nodiscard]] size_t GetBucketCount() const { return size_t{m_bucketMask} + 1; }
+    [[nodiscard]] size_t GetMemoryBytes() const { return GetBucketCount() * sizeof(Bucket); }
+
+private:
+    struct alignas(8) Bucket {
+        uint16_t slots[kSlotsPerBucket]; // 0 marks an empty slot
+    };
+
+    // Never 0, which marks an empty slot.
+    static uint16_t Fingerprint(const uint64_t hash) {
+        const auto fingerprint = static_cast<uint16_t>(hash >> 48);
+        return fingerprint ? fingerprint : 1;
+    }
+
+    // Partial-key cuckoo hashing: each bucket of a key is reachable from the other and the
+    // fingerprint alone, so kicked-out entries can move without knowing their key.
+    [[nodiscard]] uint32_t AltBucket(const uint32_t bucket, const uint16_t fingerprint) const {
+        return (bucket ^ static_cast<uint32_t>(arena_filter_detail::Mix64(fingerprint))) &
+               m_bucketMask;
+    }
+
+    bool TryPlace(const uint32_t bucket, const uint16_t fingerprint) {
+        for (uint16_t& slot : m_buckets[bucket].slots) {
+            if (slot == 0) {
+                slot = fingerprint;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool EraseFrom(const uint32_t bucket, const uint16_t fingerprint) {
+        for (uint16_t& slot : m_buckets[bucket].slots) {
+            if (slot == fingerprint) {
+                slot = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Bucket* m_buckets = nullptr; // Arena memory
+    uint32_t m_bucketMask = 0; // Bucket count - 1; the count is a power of two
+    size_t m_size = 0;
+    uint16_t m_stashFingerprint = 0; // Homeless fingerprint after a failed kick chain; 0 if none
+    uint32_t m_stashBucket = 0;
+};
+#endif //ARENA_FILTER_H
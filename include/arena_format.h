@@ -0,0 +1,237 @@
+#pragma once
+#ifndef ARENA_FORMAT_H
+#define ARENA_FORMAT_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <version>
+
+#if defined(__cpp_lib_format)
+#include <format>
+#include <iterator>
+#endif
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Builds a string directly at the top of an arena, growing it in place
+ *
+ * The text is always the most recent allocation, so appending is a TryExtend() bump instead of
+ * a reallocation. Finish() trims the block to the text plus a NUL terminator.
+ * @warning Nothing else may allocate from the arena until Finish() (or Abandon()) is called.
+ */
+class ArenaStringBuilder {
+public:
+    static constexpr size_t kInitialCapacity = 64;
+
+    /** @throws std::bad_alloc if the arena cannot hold the initial buffer */
+    explicit ArenaStringBuilder(ArenaAllocator& arena)
+        : m_arena(&arena), m_marker(arena.GetMarker()) {
+        m_data = static_cast<char*>(arena.Alloc(kInitialCapacity, 1));
+        if (!m_data) throw std::bad_alloc();
+        m_capacity = kInitialCapacity;
+    }
+
+    ArenaStringBuilder(const ArenaStringBuilder&) = delete;
+    ArenaStringBuilder& operator=(const ArenaStringBuilder&) = delete;
+
+    /** @throws std::bad_alloc (after rewinding the arena) if the text no longer fits */
+    void Append(const char c) {
+        if (m_size == m_capacity) Reserve(1);
+        m_data[m_size++] = c;
+    }
+
+    void Append(const std::string_view text) {
+        if (text.size() > m_capacity - m_size) Reserve(text.size());
+        if (!text.empty()) std::memcpy(m_data + m_size, text.data(), text.size());
+        m_size += text.size();
+    }
+
+    /** @brief Trims the allocation to the text plus a NUL terminator (not part of the view) */
+    std::string_view Finish() {
+        Append('\0');
+        (void)m_arena->TryExtend(m_data, m_capacity, m_size);
+        m_capacity = m_size;
+        return {m_data, m_size - 1};
+    }
+
+    /** @brief Gives the buffer back to the arena, e.g. when formatting throws */
+    void Abandon() { m_arena->ResetToMarker(m_marker); }
+
+    [[nodiscard]] size_t Size() const { return m_size; }
+
+private:
+    // Makes room for `extra` more characters.
+    void Reserve(const size_t extra) {
+        // More than the whole arena can never fit; checking first also keeps m_size + extra and
+        // the doubling below from wrapping around, since the capacity is capped at that size.
+        const size_t limit = m_arena->GetTotalSize();
+        if (extra > limit - m_size) {
+            Abandon();
+            throw std::bad_alloc();
+        }
+
+        const size_t needed = m_size + extra;
+        size_t capacity = m_capacity;
+        while (capacity < needed) capacity = capacity > limit / 2 ? limit : capacity * 2;
+
+        // Fall back to the exact size near the end of the arena before giving up.
+        if (!m_arena->TryExtend(m_data, m_capacity, capacity)) {
+            capacity = needed;
+            if (!m_arena->TryExtend(m_data, m_capacity, capacity)) {
+                Abandon();
+                throw std::bad_alloc();
+            }
+        }
+        m_capacity = capacity;
+    }
+
+    ArenaAllocator* m_arena;
+    ArenaAllocator::Marker m_marker; // Where the text starts, for Abandon()
+    char* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+};
+
+#if defined(__cpp_lib_format)
+
+namespace arena_format_detail {
+
+// Output iterator that feeds std::format_to straight into the builder.
+struct BuilderIterator {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    ArenaStringBuilder* builder;
+
+    BuilderIterator& operator*() { return *this; }
+    BuilderIterator& operator++() { return *this; }
+    BuilderIterator operator++(int) { return *this; }
+    BuilderIterator& operator=(const char c) {
+        builder->Append(c);
+        return *this;
+    }
+};
+
+} // namespace arena_format_detail
+
+/**
+ * @brief std::format into arena memory
+ * @return View of the formatted text (NUL-terminated), valid until the arena is reset
+ * @throws std::bad_alloc if the arena runs out of space; the partial text is released
+ */
+template <typename... Args>
+std::string_view ArenaFormat(ArenaAllocator& arena, std::format_string<Args...> fmt,
+                             Args&&... args) {
+    ArenaStringBuilder builder(arena);
+    try {
+        std::format_to(arena_format_detail::BuilderIterator{&builder}, fmt,
+                       std::forward<Args>(args)...);
+    } catch (...) {
+        builder.Abandon();
+        throw;
+    }
+    return builder.Finish();
+}
+
+#else
+
+namespace arena_format_detail {
+
+// Fallback for standard libraries without <format>: "{}" placeholders with default formatting.
+
+inline void AppendValue(ArenaStringBuilder& builder, const std::string_view value) {
+    builder.Append(value);
+}
+
+inline void AppendValue(ArenaStringBuilder& builder, const char* value) {
+    builder.Append(std::string_view(value));
+}
+
+inline void AppendValue(ArenaStringBuilder& builder, const char value) { builder.Append(value); }
+
+inline void AppendValue(ArenaStringBuilder& builder, const bool value) {
+    builder.Append(value ? std::string_view("true") : std::string_view("false"));
+}
+
+template <typename T>
+void AppendValue(ArenaStringBuilder& builder, const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        // Shortest round-trip form for floats, like std::format's default.
+        char buffer[64];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        builder.Append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+    } else if constexpr (std::is_pointer_v<T>) {
+        char buffer[2 + 16];
+        buffer[0] = '0';
+        buffer[1] = 'x';
+        const auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer),
+                                          reinterpret_cast<uintptr_t>(value), 16);
+        builder.Append(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+    } else {
+        AppendValue(builder, std::string_view(value));
+    }
+}
+
+template <typename... Args>
+void AppendArgument(ArenaStringBuilder& builder, const size_t index, const Args&... args) {
+    size_t current = 0;
+    ((current++ == index ? AppendValue(builder, args) : void()), ...);
+}
+
+} // namespace arena_format_detail
+
+/**
+ * @brief Formats into arena memory (std::format subset: "{}", "{{" and "}}" only)
+ * @return View of the formatted text (NUL-terminated), valid until the arena is reset
+ * @throws std::invalid_argument on format specs or a placeholder/argument count mismatch
+ * @throws std::bad_alloc if the arena runs out of space; the partial text is released
+ */
+template <typename... Args>
+std::string_view ArenaFormat(ArenaAllocator& arena, const std::string_view fmt,
+                             const Args&... args) {
+    ArenaStringBuilder builder(arena);
+    size_t argument = 0;
+
+    try {
+        for (size_t i = 0; i < fmt.size(); ++i) {
+            const char c = fmt[i];
+            if ((c == '{' || c == '}') && i + 1 < fmt.size() && fmt[i + 1] == c) {
+                builder.Append(c);
+                ++i;
+            } else if (c == '{') {
+                if (i + 1 >= fmt.size() || fmt[i + 1] != '}') {
+                    throw std::invalid_argument("ArenaFormat: only {} placeholders are supported");
+                }
+                if (argument >= sizeof...(Args)) {
+                    throw std::invalid_argument("ArenaFormat: not enough arguments");
+                }
+                arena_format_detail::AppendArgument(builder, argument++, args...);
+                ++i;
+            } else if (c == '}') {
+                throw std::invalid_argument("ArenaFormat: unmatched '}'");
+            } else {
+                builder.Append(c);
+            }
+        }
+    } catch (...) {
+        builder.Abandon();
+        throw;
+    }
+
+    return builder.Finish();
+}
+
+#endif
+
+#endif //ARENA_FORMAT_H
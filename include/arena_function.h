@@ -0,0 +1,89 @@
+#pragma once
+#ifndef ARENA_FUNCTION_H
+#define ARENA_FUNCTION_H
+
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "arena_allocator.h"
+
+template <typename Signature>
+class ArenaFunction;
+
+/**
+ * @brief Move-only type-erased callable whose captures live in an ArenaAllocator
+ *
+ * The callable is constructed in the arena whatever its size, so there is no small-buffer
+ * limit and no heap fallback. Calls go through a single function pointer and moving the wrapper
+ * never touches the callable itself. Captures with non-trivial destructors are destroyed with the
+ * wrapper, while their memory is reclaimed by the arena's Reset().
+ * @warning The wrapper must not be invoked or destroyed after its arena region is reset.
+ */
+template <typename R, typename... Args>
+class ArenaFunction<R(Args...)> {
+public:
+    ArenaFunction() = default;
+
+    /** @throws std::bad_alloc if the arena cannot hold the callable */
+    template <typename F, typename = std::enable_if_t<
+                              !std::is_same_v<std::decay_t<F>, ArenaFunction> &&
+                              std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+    ArenaFunction(ArenaAllocator& arena, F&& callable) {
+        using Callable = std::decay_t<F>;
+
+        Callable* stored = arena.New<Callable>(std::forward<F>(callable));
+        if (!stored) throw std::bad_alloc();
+
+        m_callable = stored;
+        m_invoke = [](void* target, Args&&... args) -> R {
+            // A void signature accepts any callable and discards what it returns.
+            if constexpr (std::is_void_v<R>) {
+                std::invoke(*static_cast<Callable*>(target), std::forward<Args>(args)...);
+            } else {
+                return std::invoke(*static_cast<Callable*>(target), std::forward<Args>(args)...);
+            }
+        };
+
+        // Trivially destructible captures (the common case) need no destroy hook at all.
+        if constexpr (!std::is_trivially_destructible_v<Callable>) {
+            m_destroy = [](void* target) { std::destroy_at(static_cast<Callable*>(target)); };
+        }
+    }
+
+    ~ArenaFunction() {
+        if (m_destroy) m_destroy(m_callable);
+    }
+
+    ArenaFunction(const ArenaFunction&) = delete;
+    ArenaFunction& operator=(const ArenaFunction&) = delete;
+
+    ArenaFunction(ArenaFunction&& other) noexcept
+        : m_callable(std::exchange(other.m_callable, nullptr)),
+          m_invoke(std::exchange(other.m_invoke, nullptr)),
+          m_destroy(std::exchange(other.m_destroy, nullptr)) {}
+
+    ArenaFunction& operator=(ArenaFunction&& other) noexcept {
+        if (this != &other) {
+            if (m_destroy) m_destroy(m_callable);
+            m_callable = std::exchange(other.m_callable, nullptr);
+            m_invoke = std::exchange(other.m_invoke, nullptr);
+            m_destroy = std::exchange(other.m_destroy, nullptr);
+        }
+        return *this;
+    }
+
+    R operator()(Args... args) const {
+        return m_invoke(m_callable, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return m_invoke != nullptr; }
+
+private:
+    void* m_callable = nullptr; // Callable object in the arena
+    R (*m_invoke)(void*, Args&&...) = nullptr;
+    void (*m_destroy)(void*) = nullptr; // Null when the callable is trivially destructible
+};
+#endif //ARENA_FUNCTION_H
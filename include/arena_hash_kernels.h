@@ -0,0 +1,614 @@
+#pragma once
+#ifndef ARENA_HASH_KERNELS_H
+#define ARENA_HASH_KERNELS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ARENA_HASH_KERNELS_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ARENA_HASH_KERNELS_SSE2 1
+#endif
+
+#include "arena_allocator.h"
+#include "arena_parallel.h"
+
+namespace arena_hash_kernels_detail {
+
+constexpr uint32_t kEmpty = 0xFFFFFFFFu;
+constexpr uint32_t kRowsPerPartition = 8192; // Keeps a partition's join table inside L2
+constexpr uint32_t kGroupsPerPartition = 65536; // Group-by rows repeat; partition by groups
+constexpr uint32_t kMaxPartitionBits = 10;
+constexpr uint64_t kMulLow = 0x9E3779B1u;
+constexpr uint64_t kMulHigh = 0x85EBCA77u;
+constexpr uint64_t kMulFold = 0xC2B2AE3Du;
+
+// Built from 32x32->64 multiplies only, which SSE2/AVX2 have (_mm_mul_epu32); the SIMD paths
+// below compute exactly this.
+inline uint32_t HashKey(const uint64_t key) {
+    const uint64_t product = ((key & 0xFFFFFFFFu) * kMulLow) ^ ((key >> 32) * kMulHigh);
+    const uint64_t fold = (product ^ (product >> 32)) & 0xFFFFFFFFu;
+    return static_cast<uint32_t>((fold * kMulFold) >> 32);
+}
+
+inline uint32_t RoundUpToPowerOfTwo(const uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+// Partition index: the top bits of the hash. Tables inside a partition use the low bits.
+inline uint32_t PartitionOf(const uint32_t hash, const uint32_t bits) {
+    return bits ? hash >> (32 - bits) : 0;
+}
+
+inline uint32_t ChoosePartitionBits(const size_t entries, const int requested,
+                                    const uint32_t perPartition) {
+    if (requested >= 0) return std::min<uint32_t>(requested, kMaxPartitionBits);
+    uint32_t bits = 0;
+    while (bits < kMaxPartitionBits && (entries >> bits) > perPartition) ++bits;
+    return bits;
+}
+
+inline std::pair<size_t, size_t> SplitRange(const size_t count, const unsigned parts,
+                                            const unsigned part) {
+    return {count * part / parts, count * (part + 1) / parts};
+}
+
+// Exception-safe and shared with the other parallel builders; rethrows the first failure.
+using arena_parallel_detail::ParallelFor;
+
+// Rows of one input after radix partitioning: partition p is [starts[p], starts[p + 1]).
+struct Partitioned {
+    uint32_t bits = 0;
+    uint32_t partitionCount = 1;
+    uint32_t largest = 0; // Rows in the biggest partition
+    const uint32_t* starts = nullptr;
+    const uint64_t* keys = nullptr;
+    const uint32_t* hashes = nullptr;
+    const uint32_t* rows = nullptr; // Input row of each entry; null when unpartitioned
+    const int64_t* values = nullptr; // Only when values were passed in
+};
+
+// Appends at the top of one arena, growing in place while nothing is allocated above it.
+template <typename T>
+struct GrowableArray {
+    ArenaAllocator* arena = nullptr;
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    void Push(const T& value) {
+        if (size == capacity) Grow(capacity ? capacity * 2 : 1024);
+        data[size++] = value;
+    }
+
+    void Grow(const size_t newCapacity) {
+        if (data && arena->TryExtend(data, capacity * sizeof(T), newCapacity * sizeof(T))) {
+            capacity = newCapacity;
+            return;
+        }
+        T* grown = arena->AllocArray<T>(newCapacity);
+        if (!grown) throw std::bad_alloc();
+        if (size) std::memcpy(grown, data, size * sizeof(T));
+        data = grown;
+        capacity = newCapacity;
+    }
+
+    // Gives back unused capacity; only works while this is still the top allocation.
+    void ShrinkToFit() {
+        if (data && arena->TryExtend(data, capacity * sizeof(T), size * sizeof(T))) {
+            capacity = size;
+        }
+    }
+};
+
+} // namespace arena_hash_kernels_detail
+
+/**
+ * @brief Hashes 64-bit keys to 32-bit hashes, 4 (AVX2) or 2 (SSE2) keys per instruction
+ *
+ * The same function as the kernels below use internally, exposed for callers that want to
+ * pre-hash a key column once and reuse it.
+ */
+inline void HashKeys(const uint64_t* keys, const size_t count, uint32_t* hashes) {
+    using namespace arena_hash_kernels_detail;
+    size_t i = 0;
+#if defined(ARENA_HASH_KERNELS_AVX2)
+    const __m256i mulLow = _mm256_set1_epi64x(kMulLow);
+    const __m256i mulHigh = _mm256_set1_epi64x(kMulHigh);
+    const __m256i mulFold = _mm256_set1_epi64x(kMulFold);
+    const __m256i packLanes = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    for (; i + 4 <= count; i += 4) {
+        const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        const __m256i product = _mm256_xor_si256(
+            _mm256_mul_epu32(key, mulLow), _mm256_mul_epu32(_mm256_srli_epi64(key, 32), mulHigh));
+        const __m256i fold = _mm256_xor_si256(product, _mm256_srli_epi64(product, 32));
+        const __m256i hash = _mm256_srli_epi64(_mm256_mul_epu32(fold, mulFold), 32);
+        const __m256i packed = _mm256_permutevar8x32_epi32(hash, packLanes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hashes + i), _mm256_castsi256_si128(packed));
+    }
+#elif defined(ARENA_HASH_KERNELS_SSE2)
+    const __m128i mulLow = _mm_set1_epi64x(kMulLow);
+    const __m128i mulHigh = _mm_set1_epi64x(kMulHigh);
+    const __m128i mulFold = _mm_set1_epi64x(kMulFold);
+    for (; i + 2 <= count; i += 2) {
+        const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        const __m128i product = _mm_xor_si128(_mm_mul_epu32(key, mulLow),
+                                              _mm_mul_epu32(_mm_srli_epi64(key, 32), mulHigh));
+        const __m128i fold = _mm_xor_si128(product, _mm_srli_epi64(product, 32));
+        const __m128i hash = _mm_srli_epi64(_mm_mul_epu32(fold, mulFold), 32);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(hashes + i),
+                         _mm_shuffle_epi32(hash, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+#endif
+    for (; i < count; ++i) hashes[i] = HashKey(keys[i]);
+}
+
+/** @brief Row pair of an equi-join: build side row, probe side row */
+struct JoinMatch {
+    uint32_t buildRow;
+    uint32_t probeRow;
+};
+
+/** @brief Join output; a view into the output arena, valid until that arena is reset */
+struct JoinResult {
+    const JoinMatch* matches = nullptr;
+    size_t count = 0;
+};
+
+/** @brief Group-by output columns; views into the output arena */
+struct GroupByResult {
+    const uint64_t* keys = nullptr;
+    const uint32_t* counts = nullptr;
+    const int64_t* sums = nullptr; // Null if no values were aggregated
+    size_t groupCount = 0;
+};
+
+struct HashKernelOptions {
+    int partitionBits = -1; // -1: pick so each partition's table stays cache-sized
+};
+
+/**
+ * @brief Radix-partitioned hash join and group-by over 64-bit key columns
+ *
+ * Both inputs are hashed (SIMD) and scattered into 2^bits partitions by the top hash bits,
+ * so each partition's hash table fits in cache. Partitioned copies and tables live in the
+ * scratch arena inside an ArenaScope; only the result is allocated in the output arena, which
+ * must therefore be a different arena.
+ *
+ * The Parallel* variants partition with all threads, then let threads claim partitions.
+ * Thread t builds its tables (and, for joins, its matches) in threadArenas[t], so no arena is
+ * ever shared between threads; those arenas are rewound before returning.
+ * Row indices are 32-bit. Output order is unspecified (and for the parallel join, varies).
+ */
+class ArenaHashKernels {
+public:
+    /**
+     * @brief Inner equi-join: every (build row, probe row) pair with equal keys
+     * @throws std::invalid_argument if output is the scratch arena
+     * @throws std::bad_alloc if an arena is out of space
+     */
+    static JoinResult HashJoin(const std::span<const uint64_t> buildKeys,
+                               const std::span<const uint64_t> probeKeys, ArenaAllocator& output,
+                               ArenaAllocator& scratch, const HashKernelOptions& options = {}) {
+        ArenaAllocator* workers[] = {&scratch};
+        return Join(buildKeys, probeKeys, output, scratch, workers, true, options);
+    }
+
+    /** @copydoc HashJoin */
+    static JoinResult ParallelHashJoin(const std::span<const uint64_t> buildKeys,
+                                       const std::span<const uint64_t> probeKeys,
+                                       ArenaAllocator& output, ArenaAllocator& scratch,
+                                       const std::span<ArenaAllocator* const> threadArenas,
+                                       const HashKernelOptions& options = {}) {
+        return Join(buildKeys, probeKeys, output, scratch, threadArenas, false, options);
+    }
+
+    /**
+     * @brief Groups rows by key with a row count and, if values is not empty, a sum per group
+     * @param values Empty, or one value per key
+     * @throws std::invalid_argument if output is the scratch arena or the sizes differ
+     * @throws std::bad_alloc if an arena is out of space
+     */
+    static GroupByResult HashGroupBy(const std::span<const uint64_t> keys,
+                                     const std::span<const int64_t> values,
+                                     ArenaAllocator& output, ArenaAllocator& scratch,
+                                     const HashKernelOptions& options = {}) {
+        ArenaAllocator* workers[] = {&scratch};
+        return GroupBy(keys, values, output, scratch, workers, true, options);
+    }
+
+    /** @copydoc HashGroupBy */
+    static GroupByResult ParallelHashGroupBy(const std::span<const uint64_t> keys,
+                                             const std::span<const int64_t> values,
+                                             ArenaAllocator& output, ArenaAllocator& scratch,
+                                             const std::span<ArenaAllocator* const> threadArenas,
+                                             const HashKernelOptions& options = {}) {
+        return GroupBy(keys, values, output, scratch, threadArenas, false, options);
+    }
+
+private:
+    using Partitioned = arena_hash_kernels_detail::Partitioned;
+
+    // Serial calls pass scratch as their only "thread arena"; parallel ones need distinct arenas.
+    static void CheckArenas(const ArenaAllocator& output, const ArenaAllocator& scratch,
+                            const std::span<ArenaAllocator* const> threadArenas,
+                            const bool serial) {
+        if (threadArenas.empty()) {
+            throw std::invalid_argument("ArenaHashKernels: no thread arenas");
+        }
+        if (&output == &scratch) {
+            throw std::invalid_argument("ArenaHashKernels: output must not be the scratch arena");
+        }
+        for (const ArenaAllocator* arena : threadArenas) {
+            if (arena == &output || (!serial && arena == &scratch)) {
+                throw std::invalid_argument(
+                    "ArenaHashKernels: thread arenas must differ from output and scratch");
+            }
+        }
+    }
+
+    // Hashes the whole key column into scratch, split over threadCount threads.
+    static const uint32_t* HashColumn(ArenaAllocator& scratch, const std::span<const uint64_t> keys,
+                                      const unsigned threadCount) {
+        using namespace arena_hash_kernels_detail;
+        auto* hashes = scratch.AllocArray<uint32_t>(keys.size());
+        if (!hashes) throw std::bad_alloc();
+        ParallelFor(scratch, threadCount, [&](const unsigned t) {
+            const auto [begin, end] = SplitRange(keys.size(), threadCount, t);
+            HashKeys(keys.data() + begin, end - begin, hashes + begin);
+        });
+        return hashes;
+    }
+
+    // Distinct hashes by linear counting over a 2^16-bit map; saturates around 500K.
+    static size_t EstimateDistinct(const uint32_t* hashes, const size_t count) {
+        constexpr uint32_t kBits = 1u << 16;
+        uint64_t seen[kBits / 64] = {};
+        for (size_t i = 0; i < count; ++i) {
+            seen[(hashes[i] & (kBits - 1)) / 64] |= uint64_t{1} << (hashes[i] % 64);
+        }
+
+        size_t zeros = 0;
+        for (const uint64_t word : seen) zeros += 64 - __builtin_popcountll(word);
+        if (zeros == 0) return count;
+        const double estimate = -static_cast<double>(kBits) *
+                                std::log(static_cast<double>(zeros) / kBits);
+        return std::min(count, static_cast<size_t>(estimate));
+    }
+
+    // Histogram and scatter into 2^bits partitions, each pass split over threadCount threads.
+    // With bits == 0 the input is used in place and rows stays null (row i is entry i).
+    static Partitioned Partition(ArenaAllocator& scratch, const std::span<const uint64_t> keys,
+                                 const uint32_t* hashes, const int64_t* values,
+                                 const uint32_t bits, const unsigned threadCount) {
+        using namespace arena_hash_kernels_detail;
+        const auto count = static_cast<uint32_t>(keys.size());
+        const uint32_t partitionCount = 1u << bits;
+
+        Partitioned result;
+        result.bits = bits;
+        result.partitionCount = partitionCount;
+
+        auto* starts = scratch.AllocArray<uint32_t>(partitionCount + 1);
+        if (!starts) throw std::bad_alloc();
+        result.starts = starts;
+        if (bits == 0) {
+            starts[0] = 0;
+            starts[1] = count;
+            result.largest = count;
+            result.keys = keys.data();
+            result.hashes = hashes;
+            result.values = values;
+            return result;
+        }
+
+        auto* outKeys = scratch.AllocArray<uint64_t>(count);
+        auto* outHashes = scratch.AllocArray<uint32_t>(count);
+        auto* outRows = scratch.AllocArray<uint32_t>(count);
+        auto* outValues = values ? scratch.AllocArray<int64_t>(count) : nullptr;
+        if (!outKeys || !outHashes || !outRows || (values && !outValues)) throw std::bad_alloc();
+
+        ArenaScope temporaries(scratch);
+        // cursors[t * P + p]: first thread t's count for partition p, then its write position.
+        const size_t cursorCount = static_cast<size_t>(threadCount) * partitionCount;
+        auto* cursors = scratch.AllocArray<uint32_t>(cursorCount);
+        if (!cursors) throw std::bad_alloc();
+        std::fill_n(cursors, cursorCount, 0u);
+
+        ParallelFor(scratch, threadCount, [&](const unsigned t) {
+            const auto [begin, end] = SplitRange(count, threadCount, t);
+            uint32_t* histogram = cursors + static_cast<size_t>(t) * partitionCount;
+            for (size_t i = begin; i < end; ++i) ++histogram[PartitionOf(hashes[i], bits)];
+        });
+
+        uint32_t running = 0;
+        for (uint32_t p = 0; p < partitionCount; ++p) {
+            starts[p] = running;
+            for (unsigned t = 0; t < threadCount; ++t) {
+                uint32_t& cursor = cursors[static_cast<size_t>(t) * partitionCount + p];
+                const uint32_t rows = cursor;
+                cursor = running;
+                running += rows;
+            }
+            result.largest = std::max(result.largest, running - starts[p]);
+        }
+        starts[partitionCount] = running;
+
+        ParallelFor(scratch, threadCount, [&](const unsigned t) {
+            const auto [begin, end] = SplitRange(count, threadCount, t);
+            uint32_t* cursor = cursors + static_cast<size_t>(t) * partitionCount;
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t slot = cursor[PartitionOf(hashes[i], bits)]++;
+                outKeys[slot] = keys[i];
+                outHashes[slot] = hashes[i];
+                outRows[slot] = static_cast<uint32_t>(i);
+                if (outValues) outValues[slot] = values[i];
+            }
+        });
+
+        result.keys = outKeys;
+        result.hashes = outHashes;
+        result.rows = outRows;
+        result.values = outValues;
+        return result;
+    }
+
+    static JoinResult Join(const std::span<const uint64_t> buildKeys,
+                           const std::span<const uint64_t> probeKeys, ArenaAllocator& output,
+                           ArenaAllocator& scratch,
+                           const std::span<ArenaAllocator* const> threadArenas,
+                           const bool serial, const HashKernelOptions& options) {
+        using namespace arena_hash_kernels_detail;
+        CheckArenas(output, scratch, threadArenas, serial);
+        if (buildKeys.empty() || probeKeys.empty()) return {};
+
+        const auto threadCount = static_cast<unsigned>(threadArenas.size());
+        ArenaScope scope(scratch);
+        const uint32_t bits = ChoosePartitionBits(buildKeys.size(), options.partitionBits,
+                                                  kRowsPerPartition);
+        const Partitioned build =
+            Partition(scratch, buildKeys, HashColumn(scratch, buildKeys, threadCount), nullptr,
+                      bits, threadCount);
+        const Partitioned probe =
+            Partition(scratch, probeKeys, HashColumn(scratch, probeKeys, threadCount), nullptr,
+                      bits, threadCount);
+
+        // Serial: matches go straight to the output arena. Parallel: each thread collects in
+        // its own arena above its tables, and the lists are concatenated at the end.
+        auto* matchLists = scratch.AllocArray<GrowableArray<JoinMatch>>(threadCount);
+        auto* markers = scratch.AllocArray<ArenaAllocator::Marker>(threadCount);
+        if (!matchLists || !markers) throw std::bad_alloc();
+        for (unsigned t = 0; t < threadCount; ++t) {
+            markers[t] = threadArenas[t]->GetMarker();
+            new (&matchLists[t]) GrowableArray<JoinMatch>{serial ? &output : threadArenas[t]};
+        }
+
+        std::atomic<uint32_t> nextPartition{0};
+        const auto work = [&](const unsigned t) {
+            ArenaAllocator& arena = *threadArenas[t];
+            const uint32_t tableCapacity = RoundUpToPowerOfTwo(std::max(2 * build.largest, 16u));
+            auto* heads = arena.AllocArray<uint32_t>(tableCapacity);
+            auto* next = arena.AllocArray<uint32_t>(build.largest);
+            if (!heads || !next) throw std::bad_alloc();
+
+            GrowableArray<JoinMatch>& matches = matchLists[t];
+            if (serial) matches.Grow(probeKeys.size()); // About one match per probe row
+            for (uint32_t p = nextPartition.fetch_add(1); p < build.partitionCount;
+                 p = nextPartition.fetch_add(1)) {
+                JoinPartition(build, probe, p, heads, next, matches);
+            }
+        };
+
+        try {
+            ParallelFor(scratch, threadCount, work);
+        } catch (...) {
+            RewindThreadArenas(threadArenas, markers, serial);
+            throw;
+        }
+
+        JoinResult result;
+        if (serial) {
+            matchLists[0].ShrinkToFit();
+            result = {matchLists[0].data, matchLists[0].size};
+        } else {
+            size_t total = 0;
+            for (unsigned t = 0; t < threadCount; ++t) total += matchLists[t].size;
+            auto* matches = output.AllocArray<JoinMatch>(total);
+            if (!matches && total) {
+                RewindThreadArenas(threadArenas, markers, serial);
+                throw std::bad_alloc();
+            }
+            size_t offset = 0;
+            for (unsigned t = 0; t < threadCount; ++t) {
+                std::copy_n(matchLists[t].data, matchLists[t].size, matches + offset);
+                offset += matchLists[t].size;
+            }
+            result = {matches, total};
+        }
+        RewindThreadArenas(threadArenas, markers, serial);
+        return result;
+    }
+
+    // Chained table over the build rows of partition p, then one probe pass.
+    static void JoinPartition(const Partitioned& build, const Partitioned& probe,
+                              const uint32_t p, uint32_t* heads, uint32_t* next,
+                              arena_hash_kernels_detail::GrowableArray<JoinMatch>& matches) {
+        using namespace arena_hash_kernels_detail;
+        const uint32_t buildBegin = build.starts[p];
+        const uint32_t buildSize = build.starts[p + 1] - buildBegin;
+        const uint32_t probeBegin = probe.starts[p];
+        const uint32_t probeEnd = probe.starts[p + 1];
+        if (buildSize == 0 || probeBegin == probeEnd) return;
+
+        const uint32_t mask = RoundUpToPowerOfTwo(std::max(2 * buildSize, 16u)) - 1;
+        std::fill_n(heads, mask + 1, kEmpty);
+        for (uint32_t local = 0; local < buildSize; ++local) {
+            uint32_t& head = heads[build.hashes[buildBegin + local] & mask];
+            next[local] = head;
+            head = local;
+        }
+
+        for (uint32_t i = probeBegin; i < probeEnd; ++i) {
+            const uint64_t key = probe.keys[i];
+            for (uint32_t local = heads[probe.hashes[i] & mask]; local != kEmpty;
+                 local = next[local]) {
+                const uint32_t entry = buildBegin + local;
+                if (build.keys[entry] == key) {
+                    matches.Push(JoinMatch{build.rows ? build.rows[entry] : entry,
+                                           probe.rows ? probe.rows[i] : i});
+                }
+            }
+        }
+    }
+
+    static GroupByResult GroupBy(const std::span<const uint64_t> keys,
+                                 const std::span<const int64_t> values, ArenaAllocator& output,
+                                 ArenaAllocator& scratch,
+                                 const std::span<ArenaAllocator* const> threadArenas,
+                                 const bool serial, const HashKernelOptions& options) {
+        using namespace arena_hash_kernels_detail;
+        CheckArenas(output, scratch, threadArenas, serial);
+        if (!values.empty() && values.size() != keys.size()) {
+            throw std::invalid_argument("ArenaHashKernels: one value per key expected");
+        }
+        if (keys.empty()) return {};
+
+        const auto threadCount = static_cast<unsigned>(threadArenas.size());
+        const int64_t* valueData = values.empty() ? nullptr : values.data();
+        ArenaScope scope(scratch);
+
+        // Partitioning only pays off once the groups outgrow the cache, so size it by the
+        // estimated group count rather than by rows. Parallel calls need partitions to share.
+        const uint32_t* hashes = HashColumn(scratch, keys, threadCount);
+        const size_t groupEstimate = EstimateDistinct(hashes, keys.size());
+        uint32_t bits = ChoosePartitionBits(groupEstimate, options.partitionBits,
+                                            kGroupsPerPartition);
+        if (options.partitionBits < 0 && !serial) {
+            while ((1u << bits) < 4 * threadCount && bits < kMaxPartitionBits) ++bits;
+        }
+        const Partitioned rows = Partition(scratch, keys, hashes, valueData, bits, threadCount);
+
+        // A partition has at most as many groups as rows, so partition p's groups are written
+        // from rows.starts[p] on: no growth and no sharing between threads.
+        auto* groupKeys = scratch.AllocArray<uint64_t>(keys.size());
+        auto* groupCounts = scratch.AllocArray<uint32_t>(keys.size());
+        auto* groupSums = valueData ? scratch.AllocArray<int64_t>(keys.size()) : nullptr;
+        auto* groupsIn = scratch.AllocArray<uint32_t>(rows.partitionCount);
+        auto* markers = scratch.AllocArray<ArenaAllocator::Marker>(threadCount);
+        if (!groupKeys || !groupCounts || (valueData && !groupSums) || !groupsIn || !markers) {
+            throw std::bad_alloc();
+        }
+        for (unsigned t = 0; t < threadCount; ++t) markers[t] = threadArenas[t]->GetMarker();
+
+        // Tables start near the expected groups per partition and double (rehashing the groups
+        // found so far) up to the largest partition's worst case, which is reserved up front.
+        const size_t expectedPerPartition = groupEstimate >> bits;
+        std::atomic<uint32_t> nextPartition{0};
+        const auto work = [&](const unsigned t) {
+            const uint32_t maxCapacity = RoundUpToPowerOfTwo(std::max(2 * rows.largest, 16u));
+            auto* slots = threadArenas[t]->AllocArray<uint32_t>(maxCapacity);
+            if (!slots) throw std::bad_alloc();
+
+            for (uint32_t p = nextPartition.fetch_add(1); p < rows.partitionCount;
+                 p = nextPartition.fetch_add(1)) {
+                const uint32_t begin = rows.starts[p];
+                const uint32_t end = rows.starts[p + 1];
+                const uint32_t rowBound = RoundUpToPowerOfTwo(std::max(2 * (end - begin), 16u));
+                uint32_t capacity = std::min(
+                    rowBound, RoundUpToPowerOfTwo(static_cast<uint32_t>(
+                                  std::min<size_t>(4 * expectedPerPartition + 16, rowBound))));
+                std::fill_n(slots, capacity, kEmpty);
+
+                uint32_t groups = 0;
+                uint64_t* partitionKeys = groupKeys + begin;
+                for (uint32_t i = begin; i < end; ++i) {
+                    const uint64_t key = rows.keys[i];
+                    uint32_t mask = capacity - 1;
+                    uint32_t slot = rows.hashes[i] & mask;
+                    while (slots[slot] != kEmpty && partitionKeys[slots[slot]] != key) {
+                        slot = (slot + 1) & mask;
+                    }
+                    if (slots[slot] == kEmpty) {
+                        if (2 * (groups + 1) > capacity) {
+                            capacity *= 2;
+                            mask = capacity - 1;
+                            Rehash(slots, capacity, partitionKeys, groups);
+                            slot = rows.hashes[i] & mask;
+                            while (slots[slot] != kEmpty) slot = (slot + 1) & mask;
+                        }
+                        slots[slot] = groups;
+                        partitionKeys[groups] = key;
+                        groupCounts[begin + groups] = 0;
+                        if (groupSums) groupSums[begin + groups] = 0;
+                        ++groups;
+                    }
+                    const uint32_t group = begin + slots[slot];
+                    ++groupCounts[group];
+                    if (groupSums) groupSums[group] += rows.values[i];
+                }
+                groupsIn[p] = groups;
+            }
+        };
+
+        try {
+            ParallelFor(scratch, threadCount, work);
+        } catch (...) {
+            RewindThreadArenas(threadArenas, markers, serial);
+            throw;
+        }
+        RewindThreadArenas(threadArenas, markers, serial);
+
+        size_t total = 0;
+        for (uint32_t p = 0; p < rows.partitionCount; ++p) total += groupsIn[p];
+        auto* outKeys = static_cast<uint64_t*>(output.Alloc(total * sizeof(uint64_t), 64));
+        auto* outCounts = static_cast<uint32_t*>(output.Alloc(total * sizeof(uint32_t), 64));
+        auto* outSums =
+            groupSums ? static_cast<int64_t*>(output.Alloc(total * sizeof(int64_t), 64)) : nullptr;
+        if (!outKeys || !outCounts || (groupSums && !outSums)) throw std::bad_alloc();
+
+        size_t offset = 0;
+        for (uint32_t p = 0; p < rows.partitionCount; ++p) {
+            const uint32_t begin = rows.starts[p];
+            std::copy_n(groupKeys + begin, groupsIn[p], outKeys + offset);
+            std::copy_n(groupCounts + begin, groupsIn[p], outCounts + offset);
+            if (outSums) std::copy_n(groupSums + begin, groupsIn[p], outSums + offset);
+            offset += groupsIn[p];
+        }
+        return {outKeys, outCounts, outSums, total};
+    }
+
+    // Reinserts groups [0, groupCount) into a cleared table of the given capacity.
+    static void Rehash(uint32_t* slots, const uint32_t capacity, const uint64_t* groupKeys,
+                       const uint32_t groupCount) {
+        using namespace arena_hash_kernels_detail;
+        const uint32_t mask = capacity - 1;
+        std::fill_n(slots, capacity, kEmpty);
+        for (uint32_t group = 0; group < groupCount; ++group) {
+            uint32_t slot = HashKey(groupKeys[group]) & mask;
+            while (slots[slot] != kEmpty) slot = (slot + 1) & mask;
+            slots[slot] = group;
+        }
+    }
+
+    // Serial calls work in scratch, whose ArenaScope already rewinds it.
+    static void RewindThreadArenas(const std::span<ArenaAllocator* const> threadArenas,
+                                   const ArenaAllocator::Marker* markers, const bool serial) {
+        if (serial) return;
+        for (size_t t = 0; t < threadArenas.size(); ++t) {
+            threadArenas[t]->ResetToMarker(markers[t]);
+        }
+    }
+};
+#endif //ARENA_HASH_KERNELS_H
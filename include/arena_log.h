@@ -0,0 +1,525 @@
+#pragma once
+#ifndef ARENA_LOG_H
+#define ARENA_LOG_H
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Binary log sink: hot threads append records to arena buffers, a background thread
+ *        formats them and writes them to a file
+ *
+ * A record is a registered format id plus its arguments in a compact tagged encoding (strings
+ * are copied). Each thread logs through its own Writer, which owns one buffer at a time, so
+ * appending a record is a bump allocation with no lock and no malloc. Only handing over a full
+ * buffer takes the sink's mutex. The background thread formats "{}" placeholders, batches the
+ * text into large fwrite calls, then Reset()s the buffer and returns it to the free list.
+ *
+ * Lines from one writer keep their order; lines from different writers are interleaved at
+ * buffer granularity. When every buffer is in flight, writers block until one is recycled.
+ * Records never wait longer than the flush interval: when it elapses, the background thread
+ * also formats what each writer has committed to its current, partly filled buffer.
+ * @warning Destroy all writers before the sink.
+ */
+class ArenaLogSink {
+    enum class ArgTag : uint8_t { Int, UInt, Float, Double, Bool, Char, String };
+
+    struct Buffer {
+        explicit Buffer(const size_t bytes) : arena(bytes) {
+            begin = static_cast<std::byte*>(arena.Alloc(0, 1)); // Base address, consumes nothing
+        }
+
+        void Rewind() {
+            arena.Reset();
+            committed.store(0, std::memory_order_relaxed);
+            consumed = 0;
+        }
+
+        ArenaAllocator arena;
+        std::byte* begin;
+        std::atomic<size_t> committed{0}; // Bytes of complete records, published by the writer
+        size_t consumed = 0; // Bytes already formatted; background thread, under the sink's mutex
+        Buffer* next = nullptr; // Link in the free list or the full queue
+    };
+
+    // Record layout: [u32 total size][u32 format id][u8 arg count] then (tag, payload) per arg.
+    static constexpr size_t kRecordHeaderSize = 4 + 4 + 1;
+
+public:
+    static constexpr uint32_t kMaxFormats = 1024;
+
+    /** @brief Per-thread handle; create one per logging thread and keep it for the thread's life */
+    class Writer {
+    public:
+        explicit Writer(ArenaLogSink& sink) : m_sink(&sink) {
+            m_sink->Register(*this);
+        }
+
+        ~Writer() {
+            if (!m_sink) return; // Moved from
+            Flush();
+            m_sink->Unregister(*this);
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        Writer(Writer&& other) noexcept : m_sink(other.m_sink) {
+            if (m_sink) m_sink->Replace(other, *this);
+            other.m_sink = nullptr;
+        }
+
+        /**
+         * @brief Appends one record; args may be integers, floats, bool, char or strings
+         * @param formatId Id returned by RegisterFormat()
+         */
+        template <typename... Args>
+        void Log(const uint32_t formatId, const Args&... args) {
+            static_assert(sizeof...(Args) < 256, "Too many log arguments");
+
+            const size_t size = kRecordHeaderSize + (size_t{0} + ... + EncodedSize(args));
+            if (size > m_sink->m_bufferBytes) {
+                m_sink->m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (!m_buffer) m_sink->AttachBuffer(*this);
+
+            auto* out = static_cast<std::byte*>(m_buffer->arena.Alloc(size, 1));
+            if (!out) {
+                m_sink->DetachBuffer(*this);
+                m_sink->AttachBuffer(*this);
+                out = static_cast<std::byte*>(m_buffer->arena.Alloc(size, 1));
+            }
+
+            const auto total = static_cast<uint32_t>(size);
+            const auto argCount = static_cast<uint8_t>(sizeof...(Args));
+            out = Put(out, &total, 4);
+            out = Put(out, &formatId, 4);
+            out = Put(out, &argCount, 1);
+            ((out = Encode(out, args)), ...);
+
+            // Lets the periodic flush format the record while the buffer is still being filled.
+            m_buffer->committed.store(m_buffer->arena.GetUsedMemory(), std::memory_order_release);
+        }
+
+        /** @brief Hands the current buffer to the background thread, even if it is not full */
+        void Flush() {
+            if (m_buffer) m_sink->DetachBuffer(*this);
+        }
+
+    private:
+        friend class ArenaLogSink;
+
+        static std::byte* Put(std::byte* out, const void* data, const size_t size) {
+            if (size > 0) std::memcpy(out, data, size);
+            return out + size;
+        }
+
+        template <typename T>
+        static constexpr ArgTag TagOf() {
+            if constexpr (std::is_same_v<T, bool>) return ArgTag::Bool;
+            else if constexpr (std::is_same_v<T, char>) return ArgTag::Char;
+            else if constexpr (std::is_same_v<T, float>) return ArgTag::Float;
+            else if constexpr (std::is_floating_point_v<T>) return ArgTag::Double;
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) return ArgTag::Int;
+            else if constexpr (std::is_integral_v<T>) return ArgTag::UInt;
+            else return ArgTag::String;
+        }
+
+        template <typename T>
+        static size_t EncodedSize(const T& value) {
+            if constexpr (TagOf<T>() == ArgTag::String) {
+                return 1 + 4 + std::string_view(value).size();
+            } else if constexpr (TagOf<T>() == ArgTag::Bool || TagOf<T>() == ArgTag::Char) {
+                return 1 + 1;
+            } else if constexpr (TagOf<T>() == ArgTag::Float) {
+                return 1 + 4;
+            } else {
+                return 1 + 8;
+            }
+        }
+
+        template <typename T>
+        static std::byte* Encode(std::byte* out, const T& value) {
+            constexpr ArgTag tag = TagOf<T>();
+            out = Put(out, &tag, 1);
+
+            if constexpr (tag == ArgTag::String) {
+                const std::string_view text(value);
+                const auto length = static_cast<uint32_t>(text.size());
+                out = Put(out, &length, 4);
+                return Put(out, text.data(), text.size());
+            } else if constexpr (tag == ArgTag::Bool || tag == ArgTag::Char) {
+                const auto byte = static_cast<uint8_t>(value);
+                return Put(out, &byte, 1);
+            } else if constexpr (tag == ArgTag::Float) {
+                // Kept as float so it is printed at float precision (0.1f, not 0.100000001...).
+                return Put(out, &value, 4);
+            } else if constexpr (tag == ArgTag::Double) {
+                const auto wide = static_cast<double>(value);
+                return Put(out, &wide, 8);
+            } else if constexpr (tag == ArgTag::Int) {
+                const auto wide = static_cast<int64_t>(value);
+                return Put(out, &wide, 8);
+            } else {
+                const auto wide = static_cast<uint64_t>(value);
+                return Put(out, &wide, 8);
+            }
+        }
+
+        ArenaLogSink* m_sink; // nullptr once moved from
+        Buffer* m_buffer = nullptr; // Filled only by this writer; changed under the sink's mutex
+        Writer* m_prevWriter = nullptr; // Registration list, guarded by the sink's mutex
+        Writer* m_nextWriter = nullptr;
+    };
+
+    /**
+     * @param path Output file, truncated on open
+     * @param bufferBytes Size of each record buffer (and the largest accepted record)
+     * @param bufferCount Buffers shared by all writers; at least one per concurrent writer
+     * @param flushInterval Longest time a committed record waits before it is written out
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit ArenaLogSink(const char* path, const size_t bufferBytes = 64 * 1024,
+                          const size_t bufferCount = 8,
+                          const std::chrono::milliseconds flushInterval =
+                              std::chrono::milliseconds(100))
+        : m_bufferBytes(bufferBytes), m_flushInterval(flushInterval), m_textArena(bufferBytes) {
+        // Closes the file if anything below throws; released once the sink is fully built.
+        std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path, "wb"));
+        if (!file) throw std::runtime_error("ArenaLogSink: cannot open log file");
+        m_file = file.get();
+
+        m_text = m_textArena.AllocArray<char>(bufferBytes);
+
+        // All buffers are created up front; logging never allocates after this point.
+        m_buffers.reserve(bufferCount);
+        for (size_t i = 0; i < bufferCount; ++i) {
+            m_buffers.push_back(std::make_unique<Buffer>(bufferBytes));
+            m_buffers.back()->next = m_freeList;
+            m_freeList = m_buffers.back().get();
+        }
+
+        m_thread = std::thread([this] { Run(); });
+        file.release();
+    }
+
+    /** @brief Drains submitted buffers, then stops the background thread and closes the file */
+    ~ArenaLogSink() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_fullCv.notify_one();
+        m_thread.join();
+        std::fclose(m_file);
+    }
+
+    ArenaLogSink(const ArenaLogSink&) = delete;
+    ArenaLogSink& operator=(const ArenaLogSink&) = delete;
+
+    /**
+     * @brief Registers a format string with "{}" placeholders ("{{" and "}}" are literal braces)
+     * @param format Must stay alive as long as the sink (typically a string literal)
+     * @throws std::length_error if kMaxFormats formats are already registered
+     */
+    uint32_t RegisterFormat(const char* format) {
+        std::lock_guard lock(m_mutex);
+        const uint32_t id = m_formatCount.load(std::memory_order_relaxed);
+        if (id == kMaxFormats) throw std::length_error("ArenaLogSink: too many formats");
+
+        m_formats[id] = format;
+        m_formatCount.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    Writer CreateWriter() { return Writer(*this); }
+
+    /** @brief Records rejected because they were larger than one buffer */
+    [[nodiscard]] uint64_t GetDroppedCount() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct FileCloser {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    void Register(Writer& writer) {
+        std::lock_guard lock(m_mutex);
+        writer.m_nextWriter = m_writers;
+        if (m_writers) m_writers->m_prevWriter = &writer;
+        m_writers = &writer;
+    }
+
+    void Unregister(Writer& writer) {
+        std::lock_guard lock(m_mutex);
+        if (writer.m_prevWriter) writer.m_prevWriter->m_nextWriter = writer.m_nextWriter;
+        else m_writers = writer.m_nextWriter;
+        if (writer.m_nextWriter) writer.m_nextWriter->m_prevWriter = writer.m_prevWriter;
+    }
+
+    // Move support: `to` takes over the buffer and the list position of `from`.
+    void Replace(Writer& from, Writer& to) {
+        std::lock_guard lock(m_mutex);
+        to.m_buffer = from.m_buffer;
+        to.m_prevWriter = from.m_prevWriter;
+        to.m_nextWriter = from.m_nextWriter;
+        if (to.m_prevWriter) to.m_prevWriter->m_nextWriter = &to;
+        else m_writers = &to;
+        if (to.m_nextWriter) to.m_nextWriter->m_prevWriter = &to;
+        from.m_buffer = nullptr;
+    }
+
+    void AttachBuffer(Writer& writer) {
+        std::unique_lock lock(m_mutex);
+        m_freeCv.wait(lock, [this] { return m_freeList != nullptr; });
+
+        Buffer* buffer = m_freeList;
+        m_freeList = buffer->next;
+        buffer->next = nullptr;
+        writer.m_buffer = buffer;
+    }
+
+    // Queues the writer's buffer for formatting, or recycles it at once if the periodic flush
+    // has already written everything in it.
+    void DetachBuffer(Writer& writer) {
+        Buffer* buffer = writer.m_buffer;
+        bool queued = false;
+        {
+            std::lock_guard lock(m_mutex);
+            writer.m_buffer = nullptr;
+            if (buffer->committed.load(std::memory_order_relaxed) > buffer->consumed) {
+                if (m_fullTail) {
+                    m_fullTail->next = buffer;
+                } else {
+                    m_fullHead = buffer;
+                }
+                m_fullTail = buffer;
+                queued = true;
+            } else {
+                buffer->Rewind();
+                buffer->next = m_freeList;
+                m_freeList = buffer;
+            }
+        }
+        if (queued) m_fullCv.notify_one();
+        else m_freeCv.notify_one();
+    }
+
+    void ReleaseBuffer(Buffer* buffer) {
+        {
+            std::lock_guard lock(m_mutex);
+            buffer->next = m_freeList;
+            m_freeList = buffer;
+        }
+        m_freeCv.notify_one();
+    }
+
+    void Run() {
+        auto nextFlush = std::chrono::steady_clock::now() + m_flushInterval;
+        for (;;) {
+            Buffer* buffer = nullptr;
+            {
+                std::unique_lock lock(m_mutex);
+                m_fullCv.wait_until(lock, nextFlush,
+                                    [this] { return m_fullHead != nullptr || m_stopping; });
+                if (!m_fullHead) {
+                    if (m_stopping) break;
+                    // Only once the queue is empty, so a writer's older buffers are always
+                    // written before what it has in its current one.
+                    FlushWritersLocked();
+                    nextFlush = std::chrono::steady_clock::now() + m_flushInterval;
+                    continue;
+                }
+
+                buffer = m_fullHead;
+                m_fullHead = buffer->next;
+                if (!m_fullHead) m_fullTail = nullptr;
+                buffer->next = nullptr;
+            }
+
+            // Queued buffers are no longer touched by writers; only the unformatted tail is left.
+            const size_t committed = buffer->committed.load(std::memory_order_relaxed);
+            WriteRecords(buffer->begin + buffer->consumed, committed - buffer->consumed);
+
+            // Recycling is just a rewind: the next writer bump-allocates from the start again.
+            buffer->Rewind();
+            ReleaseBuffer(buffer);
+        }
+
+        FlushText();
+        std::fflush(m_file);
+    }
+
+    // Periodic flush: formats the records each writer has committed to its current buffer.
+    // Holding m_mutex keeps writers from swapping buffers meanwhile; they keep logging into
+    // the bytes past `committed`, which are not read here.
+    void FlushWritersLocked() {
+        for (const Writer* writer = m_writers; writer; writer = writer->m_nextWriter) {
+            Buffer* buffer = writer->m_buffer;
+            if (!buffer) continue;
+
+            const size_t committed = buffer->committed.load(std::memory_order_acquire);
+            WriteRecords(buffer->begin + buffer->consumed, committed - buffer->consumed);
+            buffer->consumed = committed;
+        }
+        std::fflush(m_file);
+    }
+
+    void WriteRecords(const std::byte* data, const size_t size) {
+        size_t offset = 0;
+        while (offset < size) {
+            uint32_t total = 0;
+            uint32_t formatId = 0;
+            uint8_t argCount = 0;
+            std::memcpy(&total, data + offset, 4);
+            std::memcpy(&formatId, data + offset + 4, 4);
+            std::memcpy(&argCount, data + offset + 8, 1);
+
+            FormatRecord(formatId, data + offset + kRecordHeaderSize, argCount);
+            offset += total;
+        }
+        FlushText();
+    }
+
+    void FormatRecord(const uint32_t formatId, const std::byte* args, uint8_t argCount) {
+        if (formatId >= m_formatCount.load(std::memory_order_acquire)) {
+            AppendText("<unknown log format>\n");
+            return;
+        }
+
+        const std::string_view format(m_formats[formatId]);
+        for (size_t i = 0; i < format.size(); ++i) {
+            const char c = format[i];
+            if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+                AppendText(std::string_view(&format[i], 1));
+                ++i;
+            } else if (c == '{' && i + 1 < format.size() && format[i + 1] == '}' && argCount > 0) {
+                args = AppendArgument(args);
+                --argCount;
+                ++i;
+            } else {
+                AppendText(std::string_view(&format[i], 1));
+            }
+        }
+        AppendText("\n");
+    }
+
+    const std::byte* AppendArgument(const std::byte* in) {
+        ArgTag tag;
+        std::memcpy(&tag, in, 1);
+        ++in;
+
+        char digits[32];
+        std::to_chars_result result{digits, {}};
+        size_t payload = 8;
+
+        switch (tag) {
+            case ArgTag::String: {
+                uint32_t length = 0;
+                std::memcpy(&length, in, 4);
+                AppendText(std::string_view(reinterpret_cast<const char*>(in + 4), length));
+                return in + 4 + length;
+            }
+            case ArgTag::Bool: {
+                AppendText(in[0] != std::byte{0} ? "true" : "false");
+                return in + 1;
+            }
+            case ArgTag::Char: {
+                AppendText(std::string_view(reinterpret_cast<const char*>(in), 1));
+                return in + 1;
+            }
+            case ArgTag::Float: {
+                float value;
+                std::memcpy(&value, in, 4);
+                result = std::to_chars(digits, digits + sizeof(digits), value);
+                payload = 4;
+                break;
+            }
+            case ArgTag::Double: {
+                double value;
+                std::memcpy(&value, in, 8);
+                result = std::to_chars(digits, digits + sizeof(digits), value);
+                break;
+            }
+            case ArgTag::Int: {
+                int64_t value;
+                std::memcpy(&value, in, 8);
+                result = std::to_chars(digits, digits + sizeof(digits), value);
+                break;
+            }
+            case ArgTag::UInt: {
+                uint64_t value;
+                std::memcpy(&value, in, 8);
+                result = std::to_chars(digits, digits + sizeof(digits), value);
+                break;
+            }
+        }
+
+        AppendText(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+        return in + payload;
+    }
+
+    // Text is batched in an arena-backed buffer so the file sees few, large writes.
+    void AppendText(const std::string_view text) {
+        if (m_textSize + text.size() > m_bufferBytes) {
+            FlushText();
+            if (text.size() > m_bufferBytes) {
+                std::fwrite(text.data(), 1, text.size(), m_file);
+                return;
+            }
+        }
+
+        std::memcpy(m_text + m_textSize, text.data(), text.size());
+        m_textSize += text.size();
+    }
+
+    void FlushText() {
+        if (m_textSize == 0) return;
+        std::fwrite(m_text, 1, m_textSize, m_file);
+        m_textSize = 0;
+    }
+
+    const size_t m_bufferBytes;
+    const std::chrono::milliseconds m_flushInterval;
+    std::vector<std::unique_ptr<Buffer>> m_buffers; // Owns every buffer; the lists only link them
+    Buffer* m_freeList = nullptr; // Guarded by m_mutex
+    Buffer* m_fullHead = nullptr; // Submitted buffers, FIFO, guarded by m_mutex
+    Buffer* m_fullTail = nullptr;
+    Writer* m_writers = nullptr; // Live writers, for the periodic flush; guarded by m_mutex
+    bool m_stopping = false; // Guarded by m_mutex
+
+    std::mutex m_mutex;
+    std::condition_variable m_freeCv; // Writers waiting for a recycled buffer
+    std::condition_variable m_fullCv; // Background thread waiting for work
+
+    const char* m_formats[kMaxFormats] = {};
+    std::atomic<uint32_t> m_formatCount{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    // Background thread only
+    std::FILE* m_file = nullptr;
+    ArenaAllocator m_textArena;
+    char* m_text = nullptr;
+    size_t m_textSize = 0;
+
+    std::thread m_thread; // Background formatter, started once everything above is set up
+};
+#endif //ARENA_LOG_H
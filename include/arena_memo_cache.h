@@ -0,0 +1,206 @@
+#pragma once
+#ifndef ARENA_MEMO_CACHE_H
+#define ARENA_MEMO_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Memoization table whose entries live in a frame arena and vanish when it is reset
+ *
+ * Each key/value entry is allocated from the frame arena. The open-addressing slot array
+ * (linear probing, at most half full) lives in a longer-lived table arena, and every slot
+ * carries the epoch it was written in. When the frame arena has been Reset() since the last
+ * call, or rewound below the newest entry, the cache bumps its epoch. All slots then count as
+ * empty at once, with nothing cleared, evicted or freed. Invalidate() does the same by hand.
+ *
+ * Outgrown slot arrays are abandoned to the table arena, like ArenaSmallVector's spilled
+ * buffers, so size the initial capacity for a typical frame.
+ * @warning Keys and values must be trivially destructible; the arena never runs destructors.
+ *          A ResetToMarker() below the entries followed by new allocations past them before
+ *          the next cache call is not detected; mark frames with Reset() or Invalidate().
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Equal = std::equal_to<Key>>
+class ArenaMemoCache {
+    static_assert(std::is_trivially_destructible_v<Key> &&
+                      std::is_trivially_destructible_v<Value>,
+                  "Entries are dropped with the frame arena without destructors");
+
+public:
+    /**
+     * @param frameArena Arena the entries are allocated from; its Reset() empties the cache
+     * @param tableArena Arena for the slot array, which must outlive the cache
+     * @param initialCapacity Slots to start with, rounded up to a power of two
+     * @throws std::bad_alloc if the table arena is out of space
+     */
+    ArenaMemoCache(ArenaAllocator& frameArena, ArenaAllocator& tableArena,
+                   const uint32_t initialCapacity = 1024)
+        : m_frameArena(&frameArena), m_tableArena(&tableArena),
+          m_seenResets(frameArena.GetResetCount()) {
+        uint32_t capacity = 16;
+        while (capacity < initialCapacity) capacity <<= 1;
+        m_slots = NewSlots(capacity);
+        m_capacity = capacity;
+    }
+
+    ArenaMemoCache(const ArenaMemoCache&) = delete;
+    ArenaMemoCache& operator=(const ArenaMemoCache&) = delete;
+
+    /** @return The cached value of key in this frame, or nullptr */
+    [[nodiscard]] const Value* Find(const Key& key) {
+        Sync();
+        const Slot* slot = Probe(key, Mix(m_hash(key)));
+        return slot->epoch == m_epoch ? &slot->entry->value : nullptr;
+    }
+
+    /**
+     * @brief Returns the cached value of key, calling compute(key) first on a miss
+     * @note compute may use the cache itself (e.g. recursive costs).
+     * @throws std::bad_alloc if either arena is out of space
+     */
+    template <typename Compute>
+    const Value& GetOrCompute(const Key& key, Compute compute) {
+        Sync();
+        const uint32_t hash = Mix(m_hash(key));
+        if (const Slot* slot = Probe(key, hash); slot->epoch == m_epoch) {
+            ++m_hits;
+            return slot->entry->value;
+        }
+
+        ++m_misses;
+        Value value = compute(key);
+        // compute may have filled or grown the table, so probe again.
+        Sync();
+        return Insert(key, hash, std::move(value));
+    }
+
+    /**
+     * @brief Stores value for key in this frame, replacing any cached value
+     * @throws std::bad_alloc if either arena is out of space
+     */
+    const Value& Put(const Key& key, Value value) {
+        Sync();
+        return Insert(key, Mix(m_hash(key)), std::move(value));
+    }
+
+    /** @brief Empties the cache in O(1); entries stay in the frame arena until it is reset */
+    void Invalidate() {
+        m_size = 0;
+        m_entryTop = 0;
+        if (++m_epoch == 0) {
+            // After 2^32 epochs a stale stamp could match again, so clear once.
+            std::memset(static_cast<void*>(m_slots), 0, sizeof(Slot) * m_capacity);
+            m_epoch = 1;
+        }
+    }
+
+    /** @brief Entries cached in the current frame */
+    [[nodiscard]] size_t Size() {
+        Sync();
+        return m_size;
+    }
+
+    [[nodiscard]] uint32_t GetCapacity() const { return m_capacity; }
+    [[nodiscard]] uint64_t GetHitCount() const { return m_hits; }
+    [[nodiscard]] uint64_t GetMissCount() const { return m_misses; }
+
+private:
+    struct Entry {
+        Key key;
+        Value value;
+    };
+
+    struct Slot {
+        uint32_t epoch; // Occupied only when equal to m_epoch
+        uint32_t hash;
+        Entry* entry; // In the frame arena
+    };
+
+    // Fibonacci hashing: std::hash of an integer is often the identity.
+    static uint32_t Mix(const size_t hash) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    // Starts a new epoch if the frame arena was reset or rewound below the newest entry.
+    void Sync() {
+        const uint64_t resets = m_frameArena->GetResetCount();
+        if (resets != m_seenResets || m_frameArena->GetUsedMemory() < m_entryTop) {
+            m_seenResets = resets;
+            Invalidate();
+        }
+    }
+
+    // Slot holding key in this epoch, or the free slot where it would go.
+    Slot* Probe(const Key& key, const uint32_t hash) const {
+        const uint32_t mask = m_capacity - 1;
+        for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = m_slots[i];
+            if (slot.epoch != m_epoch) return &slot;
+            if (slot.hash == hash && m_equal(slot.entry->key, key)) return &slot;
+        }
+    }
+
+    const Value& Insert(const Key& key, const uint32_t hash, Value&& value) {
+        Slot* slot = Probe(key, hash);
+        if (slot->epoch == m_epoch) {
+            slot->entry->value = std::move(value);
+            return slot->entry->value;
+        }
+
+        if (2 * (m_size + 1) > m_capacity) {
+            Grow();
+            slot = Probe(key, hash);
+        }
+        Entry* entry = m_frameArena->New<Entry>(Entry{key, std::move(value)});
+        if (!entry) throw std::bad_alloc();
+        m_entryTop = m_frameArena->GetUsedMemory();
+
+        *slot = Slot{m_epoch, hash, entry};
+        ++m_size;
+        return entry->value;
+    }
+
+    // Doubles the slot array and moves this epoch's entries over; stale slots are dropped.
+    void Grow() {
+        const uint32_t capacity = m_capacity * 2;
+        Slot* slots = NewSlots(capacity);
+        const uint32_t mask = capacity - 1;
+        for (uint32_t i = 0; i < m_capacity; ++i) {
+            if (m_slots[i].epoch != m_epoch) continue;
+            uint32_t target = m_slots[i].hash & mask;
+            while (slots[target].epoch == m_epoch) target = (target + 1) & mask;
+            slots[target] = m_slots[i];
+        }
+        m_slots = slots;
+        m_capacity = capacity;
+    }
+
+    Slot* NewSlots(const uint32_t capacity) {
+        auto* slots = m_tableArena->AllocArray<Slot>(capacity);
+        if (!slots) throw std::bad_alloc();
+        std::memset(static_cast<void*>(slots), 0, sizeof(Slot) * capacity); // Epoch 0: empty
+        return slots;
+    }
+
+    ArenaAllocator* m_frameArena; // Entries
+    ArenaAllocator* m_tableArena; // Slot arrays
+    Slot* m_slots = nullptr;
+    uint32_t m_capacity = 0; // Power of two
+    uint32_t m_epoch = 1;
+    size_t m_size = 0; // Entries in this epoch
+    uint64_t m_seenResets; // Frame arena GetResetCount() as of the current epoch
+    size_t m_entryTop = 0; // Frame arena offset just past the newest entry
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] Equal m_equal;
+};
+#endif //ARENA_MEMO_CACHE_H
@@ -0,0 +1,39 @@
+#pragma once
+#ifndef ARENA_MEMORY_RESOURCE_H
+#define ARENA_MEMORY_RESOURCE_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief std::pmr adapter: lets std::pmr containers allocate from an ArenaAllocator
+ *
+ * Works like std::pmr::monotonic_buffer_resource over the arena's block: deallocate() is a
+ * no-op and memory comes back on the arena's Reset(). There is no upstream fallback, so a full
+ * arena throws std::bad_alloc just like the arena-backed containers do.
+ */
+class ArenaMemoryResource final : public std::pmr::memory_resource {
+public:
+    explicit ArenaMemoryResource(ArenaAllocator& arena) : m_arena(arena) {}
+
+    [[nodiscard]] ArenaAllocator& GetArena() const { return m_arena; }
+
+private:
+    void* do_allocate(const size_t bytes, const size_t alignment) override {
+        void* memory = m_arena.Alloc(bytes, alignment);
+        if (!memory) throw std::bad_alloc();
+        return memory;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    ArenaAllocator& m_arena;
+};
+#endif //ARENA_MEMORY_RESOURCE_H
@@ -0,0 +1,219 @@
+#pragma once
+#ifndef ARENA_OCCUPANCY_H
+#define ARENA_OCCUPANCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Layout of an arena at one moment: every live allocation with its padding and tag
+ *
+ * Written by ArenaOccupancyRecorder and read back by tools/arena_occupancy_view. The file
+ * stores integers in host byte order, so read it on the same kind of machine.
+ */
+struct ArenaOccupancyMap {
+    static constexpr char kMagic[4] = {'A', 'O', 'C', 'C'};
+    static constexpr uint32_t kVersion = 1;
+
+    struct Allocation {
+        uint64_t offset; // Start of the payload, from the start of the arena
+        uint64_t size;
+        uint32_t padding; // Alignment bytes just before offset
+        uint32_t align;
+        uint32_t tag; // Index into tags
+        uint32_t reserved;
+    };
+
+    uint64_t totalSize = 0;
+    uint64_t usedMemory = 0;
+    std::vector<std::string> tags; // tags[0] is "untagged"
+    std::vector<Allocation> allocations; // Sorted by offset
+
+    /** @throws std::runtime_error if the file cannot be written */
+    void Write(const char* path) const {
+        FILE* file = std::fopen(path, "wb");
+        if (!file) throw std::runtime_error("ArenaOccupancyMap: cannot open output file");
+
+        const FileHeader header{{kMagic[0], kMagic[1], kMagic[2], kMagic[3]}, kVersion,
+                                static_cast<uint32_t>(tags.size()), 0, totalSize, usedMemory,
+                                allocations.size()};
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        for (const std::string& tag : tags) {
+            const auto length = static_cast<uint32_t>(tag.size());
+            ok = ok && std::fwrite(&length, sizeof(length), 1, file) == 1;
+            ok = ok && std::fwrite(tag.data(), 1, tag.size(), file) == tag.size();
+        }
+        if (!allocations.empty()) {
+            ok = ok && std::fwrite(allocations.data(), sizeof(Allocation), allocations.size(),
+                                   file) == allocations.size();
+        }
+
+        if (std::fclose(file) != 0 || !ok) {
+            throw std::runtime_error("ArenaOccupancyMap: write failed");
+        }
+    }
+
+    /** @throws std::runtime_error if the file is missing, truncated or not an occupancy map */
+    static ArenaOccupancyMap Load(const char* path) {
+        FILE* file = std::fopen(path, "rb");
+        if (!file) throw std::runtime_error("ArenaOccupancyMap: cannot open input file");
+
+        ArenaOccupancyMap map;
+        FileHeader header{};
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+                  std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                  header.version == kVersion;
+
+        for (uint32_t i = 0; ok && i < header.tagCount; ++i) {
+            uint32_t length = 0;
+            ok = std::fread(&length, sizeof(length), 1, file) == 1 && length <= 4096;
+            std::string tag(ok ? length : 0, '\0');
+            ok = ok && std::fread(tag.data(), 1, length, file) == length;
+            map.tags.push_back(std::move(tag));
+        }
+
+        if (ok) {
+            // Check the count against what the rest of the file can hold before allocating for
+            // it, so a corrupt header fails here instead of in resize().
+            const long position = std::ftell(file);
+            ok = position >= 0 && std::fseek(file, 0, SEEK_END) == 0;
+            const long end = ok ? std::ftell(file) : -1;
+            const auto remaining = static_cast<uint64_t>(end - position);
+            ok = ok && end >= position && std::fseek(file, position, SEEK_SET) == 0 &&
+                 header.allocationCount <= remaining / sizeof(Allocation);
+        }
+        if (ok) {
+            map.allocations.resize(header.allocationCount);
+            ok = std::fread(map.allocations.data(), sizeof(Allocation), map.allocations.size(),
+                            file) == map.allocations.size();
+        }
+        std::fclose(file);
+
+        if (!ok) throw std::runtime_error("ArenaOccupancyMap: not a valid occupancy file");
+        map.totalSize = header.totalSize;
+        map.usedMemory = header.usedMemory;
+        return map;
+    }
+
+private:
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t tagCount;
+        uint32_t reserved;
+        uint64_t totalSize;
+        uint64_t usedMemory;
+        uint64_t allocationCount;
+    };
+};
+
+namespace arena_occupancy_detail {
+
+// Label for allocations made on this thread; set through ArenaOccupancyTag.
+inline thread_local const char* t_currentTag = nullptr;
+
+} // namespace arena_occupancy_detail
+
+/**
+ * @brief Labels this thread's allocations while in scope (nests; the innermost tag wins)
+ * @param tag Must outlive every recorder that sees it, e.g. a string literal
+ */
+class ArenaOccupancyTag {
+public:
+    explicit ArenaOccupancyTag(const char* tag) : m_previous(arena_occupancy_detail::t_currentTag) {
+        arena_occupancy_detail::t_currentTag = tag;
+    }
+
+    ~ArenaOccupancyTag() {
+        arena_occupancy_detail::t_currentTag = m_previous;
+    }
+
+    ArenaOccupancyTag(const ArenaOccupancyTag&) = delete;
+    ArenaOccupancyTag& operator=(const ArenaOccupancyTag&) = delete;
+
+private:
+    const char* m_previous;
+};
+
+#if defined(ARENA_ENABLE_OCCUPANCY_TRACE)
+
+/**
+ * @brief Debug observer that mirrors an arena's live allocations for Snapshot()
+ *
+ * Bookkeeping lives on the heap, not in the observed arena. Rewinds drop the records above
+ * the marker, so a snapshot always matches what is currently in the arena.
+ * @warning Requires ARENA_ENABLE_OCCUPANCY_TRACE for the whole program (CMake option of the
+ * same name). Must not outlive the arena.
+ */
+class ArenaOccupancyRecorder final : public ArenaAllocationObserver {
+public:
+    explicit ArenaOccupancyRecorder(ArenaAllocator& arena) : m_arena(arena) {
+        m_tags.emplace_back("untagged");
+        m_arena.SetObserver(this);
+    }
+
+    ~ArenaOccupancyRecorder() override {
+        m_arena.SetObserver(nullptr);
+    }
+
+    ArenaOccupancyRecorder(const ArenaOccupancyRecorder&) = delete;
+    ArenaOccupancyRecorder& operator=(const ArenaOccupancyRecorder&) = delete;
+
+    void OnAlloc(const size_t offset, const size_t size, const size_t align,
+                 const size_t padding) override {
+        m_allocations.push_back(ArenaOccupancyMap::Allocation{
+            offset, size, static_cast<uint32_t>(padding), static_cast<uint32_t>(align),
+            TagId(arena_occupancy_detail::t_currentTag), 0});
+    }
+
+    void OnExtend(const size_t offset, const size_t newSize) override {
+        if (!m_allocations.empty() && m_allocations.back().offset == offset) {
+            m_allocations.back().size = newSize;
+        }
+    }
+
+    void OnRewind(const size_t offset) override {
+        while (!m_allocations.empty() && m_allocations.back().offset >= offset) {
+            m_allocations.pop_back();
+        }
+    }
+
+    /** @brief Copies the current layout; live allocations are already sorted by offset */
+    [[nodiscard]] ArenaOccupancyMap Snapshot() const {
+        ArenaOccupancyMap map;
+        map.totalSize = m_arena.GetTotalSize();
+        map.usedMemory = m_arena.GetUsedMemory();
+        map.tags = m_tags;
+        map.allocations = m_allocations;
+        return map;
+    }
+
+    /** @throws std::runtime_error if the file cannot be written */
+    void WriteFile(const char* path) const { Snapshot().Write(path); }
+
+private:
+    uint32_t TagId(const char* tag) {
+        if (!tag) return 0;
+        const auto [it, inserted] = m_tagIds.try_emplace(tag, static_cast<uint32_t>(m_tags.size()));
+        if (inserted) m_tags.emplace_back(tag);
+        return it->second;
+    }
+
+    ArenaAllocator& m_arena;
+    std::vector<ArenaOccupancyMap::Allocation> m_allocations; // Live allocations, by offset
+    std::vector<std::string> m_tags;
+    std::unordered_map<const char*, uint32_t> m_tagIds; // Interned by pointer identity
+};
+
+#endif
+
+#endif //ARENA_OCCUPANCY_H
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef ARENA_PARALLEL_H
+#define ARENA_PARALLEL_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "arena_allocator.h"
+
+namespace arena_parallel_detail {
+
+/**
+ * @brief Runs func(0) on the calling thread and func(1..count-1) on workers placed in scratch
+ *
+ * Shared by the parallel builders (CsrGraphBuilder, ArenaStringTable::Sort, ArenaHashKernels).
+ * Every started thread is joined before this returns or throws, even if a later thread fails
+ * to start. The first exception thrown by func on any thread, or by a thread launch, is
+ * rethrown after the join; once one is seen no further workers are launched and func(0) is
+ * skipped, so callers must treat the whole pass as failed.
+ * @throws std::bad_alloc if scratch cannot hold the thread objects
+ */
+template <typename Func>
+void ParallelFor(ArenaAllocator& scratch, const unsigned count, Func func) {
+    if (count <= 1) {
+        func(0u);
+        return;
+    }
+
+    ArenaScope scope(scratch);
+    auto* threads = scratch.AllocArray<std::thread>(count - 1);
+    if (!threads) throw std::bad_alloc();
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr firstError; // Written once by whoever sets failed; read after joining
+    const auto record = [&] {
+        if (!failed.exchange(true)) firstError = std::current_exception();
+    };
+    const auto guarded = [&](const unsigned t) {
+        try {
+            func(t);
+        } catch (...) {
+            record();
+        }
+    };
+
+    unsigned started = 0;
+    for (unsigned t = 1; t < count && !failed.load(); ++t) {
+        try {
+            new (&threads[t - 1]) std::thread(guarded, t);
+            ++started;
+        } catch (...) {
+            record();
+        }
+    }
+    if (!failed.load()) guarded(0u);
+
+    for (unsigned t = 0; t < started; ++t) {
+        threads[t].join();
+        std::destroy_at(&threads[t]);
+    }
+    if (firstError) std::rethrow_exception(firstError);
+}
+
+} // namespace arena_parallel_detail
+#endif //ARENA_PARALLEL_H
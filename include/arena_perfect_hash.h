@@ -0,0 +1,455 @@
+#pragma once
+#ifndef ARENA_PERFECT_HASH_H
+#define ARENA_PERFECT_HASH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "arena_allocator.h"
+#include "arena_deque.h"
+
+namespace arena_perfect_hash_detail {
+
+constexpr uint32_t kMagic = 0x48504641; // "AFPH"
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kMaxSeeds = 32; // Build() attempts before giving up
+
+// Stable across processes and builds (unlike std::hash), which snapshots depend on.
+inline uint64_t Mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t HashBytes(const std::byte* data, const size_t length, const uint64_t seed) {
+    uint64_t hash = seed ^ (length * 0x9e3779b97f4a7c15ULL);
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = Mix64(hash ^ word) + 0x9e3779b97f4a7c15ULL;
+    }
+
+    uint64_t tail = 0;
+    if (i < length) std::memcpy(&tail, data + i, length - i);
+    return Mix64(hash ^ tail);
+}
+
+// The d-th candidate slot for a key; each displacement value acts as a fresh hash function.
+inline uint32_t SlotFor(const uint64_t hash, const uint32_t displacement, const uint32_t slotCount) {
+    return static_cast<uint32_t>(Mix64(hash + displacement * 0x9e3779b97f4a7c15ULL) % slotCount);
+}
+
+inline size_t AlignUp(const size_t value, const size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+// About 3% spare slots: with a full table the last buckets each need ~n tries to find the
+// one free slot, so large builds would stall. The spare slots are remapped afterwards.
+inline uint32_t SlotCountFor(const uint32_t keyCount) {
+    return keyCount ? keyCount + keyCount / 32 + 1 : 0;
+}
+
+// True if [offset, offset + count * size) lies within total, without overflowing.
+inline bool FitsIn(const uint64_t offset, const uint64_t count, const uint64_t size,
+                   const uint64_t total) {
+    return offset <= total && count <= (total - offset) / size;
+}
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t seed;
+    uint32_t keyCount; // Also the number of stored slots: the hash is minimal
+    uint32_t bucketCount;
+    uint32_t slotCount; // Slots probed; those at keyCount and above are remapped below it
+    uint32_t valueSize;
+    uint32_t valueAlign;
+    uint32_t reserved;
+    uint64_t displacementsOffset; // All offsets are relative to the header
+    uint64_t remapOffset; // slotCount - keyCount entries
+    uint64_t slotsOffset;
+    uint64_t keyBytesOffset;
+    uint64_t totalSize;
+};
+
+} // namespace arena_perfect_hash_detail
+
+/**
+ * @brief Read-only minimal perfect hash map stored in one position-independent block
+ *
+ * The block holds a header, one displacement word per bucket (CHD "hash and displace"),
+ * a small remap table, one slot per key and the key bytes, linked by offsets rather than
+ * pointers. Keys are placed among ~3% more slots than keys so the search stays fast at
+ * millions of keys; the few keys landing past the end are remapped into the holes, as in
+ * CHD. The block can be written to a file as-is and later viewed in place from mmap'd memory
+ * with FromBytes(), which validates it first.
+ *
+ * A lookup reads one displacement word and one slot; the key bytes are only compared when
+ * the slot's 64-bit hash matches, so misses almost never touch a third cache line.
+ */
+template <typename Value>
+class FrozenHashMap {
+    static_assert(std::is_trivially_copyable_v<Value>,
+                  "Snapshot values are copied byte-wise and must be trivially copyable");
+
+public:
+    struct Slot {
+        uint64_t hash;
+        uint32_t keyOffset; // Relative to the key byte region
+        uint32_t keyLength;
+        Value value;
+    };
+
+    /** @brief Empty, invalid map */
+    FrozenHashMap() = default;
+
+    /**
+     * @brief Views a block produced by FrozenHashMapBuilder (e.g. from mmap) without copying
+     *
+     * Checks the header, that every table lies inside the block and that remap entries
+     * point at stored slots, so a truncated or corrupt file cannot make lookups read out of
+     * bounds. Slots' key ranges are checked by Find() itself.
+     * @return An invalid map if the block is misaligned, does not match this Value type or
+     *         its tables do not fit in size bytes
+     */
+    [[nodiscard]] static FrozenHashMap FromBytes(const void* data, const size_t size) {
+        using namespace arena_perfect_hash_detail;
+
+        constexpr size_t kAlign = std::max(alignof(Header), alignof(Slot));
+        if (!data || size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % kAlign != 0) {
+            return {};
+        }
+
+        const auto* block = static_cast<const std::byte*>(data);
+        const auto* header = reinterpret_cast<const Header*>(block);
+        const uint64_t total = header->totalSize;
+        if (header->magic != kMagic || header->version != kVersion ||
+            header->valueSize != sizeof(Value) || header->valueAlign != alignof(Value) ||
+            total > size || header->bucketCount == 0 || header->slotCount < header->keyCount ||
+            (header->keyCount == 0) != (header->slotCount == 0) ||
+            header->displacementsOffset < sizeof(Header) ||
+            header->displacementsOffset % alignof(uint32_t) != 0 ||
+            header->remapOffset % alignof(uint32_t) != 0 ||
+            header->slotsOffset % alignof(Slot) != 0 ||
+            !FitsIn(header->displacementsOffset, header->bucketCount, sizeof(uint32_t), total) ||
+            !FitsIn(header->remapOffset, header->slotCount - header->keyCount, sizeof(uint32_t),
+                    total) ||
+            !FitsIn(header->slotsOffset, header->keyCount, sizeof(Slot), total) ||
+            header->keyBytesOffset > total) {
+            return {};
+        }
+
+        const auto* remap = reinterpret_cast<const uint32_t*>(block + header->remapOffset);
+        for (uint32_t i = 0; i < header->slotCount - header->keyCount; ++i) {
+            if (remap[i] >= header->keyCount) return {};
+        }
+
+        return FrozenHashMap(block);
+    }
+
+    /** @return Pointer to the value, or nullptr if the key is not in the map */
+    [[nodiscard]] const Value* Find(const std::string_view key) const {
+        using namespace arena_perfect_hash_detail;
+
+        const Header* header = GetHeader();
+        if (!header || header->keyCount == 0) return nullptr;
+
+        const auto* bytes = reinterpret_cast<const std::byte*>(key.data());
+        const uint64_t hash = HashBytes(bytes, key.size(), header->seed);
+        const uint32_t displacement = Displacements()[hash % header->bucketCount];
+        uint32_t index = SlotFor(hash, displacement, header->slotCount);
+        if (index >= header->keyCount) index = Remap()[index - header->keyCount];
+        const Slot& slot = Slots()[index];
+
+        const uint64_t keyRegion = header->totalSize - header->keyBytesOffset;
+        if (slot.hash != hash || slot.keyLength != key.size() ||
+            uint64_t{slot.keyOffset} + slot.keyLength > keyRegion ||
+            (!key.empty() && std::memcmp(KeyBytes() + slot.keyOffset, bytes, key.size()) != 0)) {
+            return nullptr;
+        }
+
+        return &slot.value;
+    }
+
+    [[nodiscard]] const Value* Find(const uint64_t key) const {
+        return Find(std::string_view(reinterpret_cast<const char*>(&key), sizeof(key)));
+    }
+
+    [[nodiscard]] bool IsValid() const { return m_block != nullptr; }
+    [[nodiscard]] size_t Size() const { return m_block ? GetHeader()->keyCount : 0; }
+
+    /** @brief Start of the snapshot block; write SizeInBytes() bytes from here to persist it */
+    [[nodiscard]] const void* Data() const { return m_block; }
+    [[nodiscard]] size_t SizeInBytes() const { return m_block ? GetHeader()->totalSize : 0; }
+
+private:
+    template <typename>
+    friend class FrozenHashMapBuilder;
+
+    explicit FrozenHashMap(const std::byte* block) : m_block(block) {}
+
+    const arena_perfect_hash_detail::Header* GetHeader() const {
+        return reinterpret_cast<const arena_perfect_hash_detail::Header*>(m_block);
+    }
+    const uint32_t* Displacements() const {
+        return reinterpret_cast<const uint32_t*>(m_block + GetHeader()->displacementsOffset);
+    }
+    const uint32_t* Remap() const {
+        return reinterpret_cast<const uint32_t*>(m_block + GetHeader()->remapOffset);
+    }
+    const Slot* Slots() const {
+        return reinterpret_cast<const Slot*>(m_block + GetHeader()->slotsOffset);
+    }
+    const std::byte* KeyBytes() const { return m_block + GetHeader()->keyBytesOffset; }
+
+    const std::byte* m_block = nullptr; // Header followed by the tables
+};
+
+/**
+ * @brief Accumulates keys in an arena and freezes them into a FrozenHashMap
+ *
+ * Build() places the finished block in the same arena, then runs its bucket sort and
+ * displacement search in an ArenaScope above it, so only the block itself stays allocated.
+ * @warning Build() does not release the accumulated keys; reset the arena at phase end.
+ */
+template <typename Value>
+class FrozenHashMapBuilder {
+    struct Entry {
+        const std::byte* key;
+        uint32_t keyLength;
+        Value value;
+    };
+
+public:
+    explicit FrozenHashMapBuilder(ArenaAllocator& arena) : m_arena(&arena), m_entries(arena) {}
+
+    /** @throws std::bad_alloc if the arena cannot hold the key copy */
+    void Add(const std::string_view key, const Value& value) {
+        auto* copy = m_arena->AllocArray<std::byte>(key.size());
+        if (!copy && !key.empty()) throw std::bad_alloc();
+
+        if (!key.empty()) std::memcpy(copy, key.data(), key.size());
+        m_entries.PushBack(Entry{copy, static_cast<uint32_t>(key.size()), value});
+        m_keyBytes += key.size();
+    }
+
+    void Add(const uint64_t key, const Value& value) {
+        Add(std::string_view(reinterpret_cast<const char*>(&key), sizeof(key)), value);
+    }
+
+    [[nodiscard]] size_t Size() const { return m_entries.Size(); }
+
+    /**
+     * @throws std::invalid_argument if the same key was added twice
+     * @throws std::runtime_error if no seed places every key (not expected in practice)
+     * @throws std::bad_alloc if the arena cannot hold the block or the build scratch
+     */
+    FrozenHashMap<Value> Build() {
+        using namespace arena_perfect_hash_detail;
+        using Slot = typename FrozenHashMap<Value>::Slot;
+
+        const auto keyCount = static_cast<uint32_t>(m_entries.Size());
+        // ~4 keys per bucket keeps the displacement table small and the search fast.
+        const uint32_t bucketCount = std::max<uint32_t>(1, keyCount / 4);
+        const uint32_t slotCount = SlotCountFor(keyCount);
+
+        Header header{};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.keyCount = keyCount;
+        header.bucketCount = bucketCount;
+        header.slotCount = slotCount;
+        header.valueSize = sizeof(Value);
+        header.valueAlign = alignof(Value);
+        header.displacementsOffset = AlignUp(sizeof(Header), alignof(uint32_t));
+        header.remapOffset = header.displacementsOffset + bucketCount * sizeof(uint32_t);
+        header.slotsOffset = AlignUp(
+            header.remapOffset + (slotCount - keyCount) * sizeof(uint32_t), alignof(Slot));
+        header.keyBytesOffset = header.slotsOffset + keyCount * sizeof(Slot);
+        header.totalSize = header.keyBytesOffset + m_keyBytes;
+
+        auto* block = static_cast<std::byte*>(m_arena->Alloc(header.totalSize, 64));
+        if (!block) throw std::bad_alloc();
+
+        // Zero padding bytes too, so identical inputs produce byte-identical snapshots.
+        std::memset(block, 0, header.totalSize);
+
+        ArenaScope scratch(*m_arena);
+
+        auto* entries = m_arena->AllocArray<const Entry*>(keyCount);
+        auto* hashes = m_arena->AllocArray<uint64_t>(keyCount);
+        auto* bucketStarts = m_arena->AllocArray<uint32_t>(bucketCount + 1);
+        auto* bucketOrder = m_arena->AllocArray<uint32_t>(bucketCount);
+        auto* grouped = m_arena->AllocArray<uint32_t>(keyCount);
+        auto* taken = m_arena->AllocArray<uint64_t>(slotCount / 64 + 1);
+        auto* candidates = m_arena->AllocArray<uint32_t>(keyCount + 1);
+        if (!entries || !hashes || !bucketStarts || !bucketOrder || !grouped || !taken ||
+            !candidates) {
+            throw std::bad_alloc();
+        }
+
+        uint32_t index = 0;
+        for (const Entry& entry : m_entries) {
+            entries[index++] = &entry;
+        }
+
+        auto* displacements = reinterpret_cast<uint32_t*>(block + header.displacementsOffset);
+        auto* remap = reinterpret_cast<uint32_t*>(block + header.remapOffset);
+
+        // A seed fails only if two distinct keys collide on all 64 hash bits or a bucket
+        // exhausts its displacement budget; both are rare enough that retrying is cheap.
+        bool placed = false;
+        uint64_t seed = 0x5eed;
+        for (uint32_t attempt = 0; attempt < kMaxSeeds && !placed; ++attempt) {
+            if (attempt > 0) seed = Mix64(seed);
+            for (uint32_t i = 0; i < keyCount; ++i) {
+                hashes[i] = HashBytes(entries[i]->key, entries[i]->keyLength, seed);
+            }
+
+            GroupByBucket(hashes, keyCount, bucketCount, bucketStarts, grouped);
+            if (!CheckDistinctHashes(entries, hashes, bucketStarts, grouped, bucketCount)) continue;
+            SortBucketsBySize(bucketStarts, bucketCount, bucketOrder);
+
+            placed = PlaceBuckets(hashes, slotCount, bucketStarts, bucketOrder, bucketCount,
+                                  grouped, taken, candidates, displacements);
+        }
+        if (!placed) throw std::runtime_error("FrozenHashMapBuilder: no seed placed every key");
+        header.seed = seed;
+
+        // Exactly as many holes below keyCount as taken slots at or above it; pair them up.
+        uint32_t hole = 0;
+        for (uint32_t slot = keyCount; slot < slotCount; ++slot) {
+            if (!(taken[slot / 64] & (1ull << (slot % 64)))) continue;
+            while (taken[hole / 64] & (1ull << (hole % 64))) ++hole;
+            remap[slot - keyCount] = hole++;
+        }
+
+        std::memcpy(block, &header, sizeof(Header));
+
+        auto* slots = reinterpret_cast<Slot*>(block + header.slotsOffset);
+        std::byte* keyBytes = block + header.keyBytesOffset;
+        uint32_t keyOffset = 0;
+
+        for (uint32_t i = 0; i < keyCount; ++i) {
+            const uint32_t displacement = displacements[hashes[i] % bucketCount];
+            uint32_t index = SlotFor(hashes[i], displacement, slotCount);
+            if (index >= keyCount) index = remap[index - keyCount];
+            Slot& slot = slots[index];
+            slot.hash = hashes[i];
+            slot.keyOffset = keyOffset;
+            slot.keyLength = entries[i]->keyLength;
+            slot.value = entries[i]->value;
+
+            if (entries[i]->keyLength > 0) {
+                std::memcpy(keyBytes + keyOffset, entries[i]->key, entries[i]->keyLength);
+            }
+            keyOffset += entries[i]->keyLength;
+        }
+
+        return FrozenHashMap<Value>(block);
+    }
+
+private:
+    // Counting sort of key indices by bucket; bucket b owns grouped[starts[b], starts[b + 1]).
+    static void GroupByBucket(const uint64_t* hashes, const uint32_t keyCount,
+                              const uint32_t bucketCount, uint32_t* starts, uint32_t* grouped) {
+        std::fill_n(starts, bucketCount + 1, 0u);
+        for (uint32_t i = 0; i < keyCount; ++i) ++starts[hashes[i] % bucketCount + 1];
+        for (uint32_t b = 0; b < bucketCount; ++b) starts[b + 1] += starts[b];
+
+        // starts[b] is used as a write cursor, then shifted back into place.
+        for (uint32_t i = 0; i < keyCount; ++i) grouped[starts[hashes[i] % bucketCount]++] = i;
+        for (uint32_t b = bucketCount; b > 0; --b) starts[b] = starts[b - 1];
+        starts[0] = 0;
+    }
+
+    // Equal hashes inside a bucket are either a duplicate key (caller error) or a seed to retry.
+    static bool CheckDistinctHashes(const Entry* const* entries, const uint64_t* hashes,
+                                    const uint32_t* starts, const uint32_t* grouped,
+                                    const uint32_t bucketCount) {
+        for (uint32_t b = 0; b < bucketCount; ++b) {
+            for (uint32_t i = starts[b]; i < starts[b + 1]; ++i) {
+                for (uint32_t j = starts[b]; j < i; ++j) {
+                    if (hashes[grouped[i]] != hashes[grouped[j]]) continue;
+
+                    const Entry* a = entries[grouped[i]];
+                    const Entry* c = entries[grouped[j]];
+                    if (a->keyLength == c->keyLength &&
+                        std::memcmp(a->key, c->key, a->keyLength) == 0) {
+                        throw std::invalid_argument("FrozenHashMapBuilder: duplicate key");
+                    }
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static void SortBucketsBySize(const uint32_t* starts, const uint32_t bucketCount,
+                                  uint32_t* order) {
+        for (uint32_t b = 0; b < bucketCount; ++b) order[b] = b;
+        std::sort(order, order + bucketCount, [starts](const uint32_t a, const uint32_t b) {
+            return starts[a + 1] - starts[a] > starts[b + 1] - starts[b];
+        });
+    }
+
+    // Largest buckets go first while the table is still empty; each bucket takes the first
+    // displacement that sends all of its keys to distinct free slots.
+    static bool PlaceBuckets(const uint64_t* hashes, const uint32_t slotCount,
+                             const uint32_t* starts, const uint32_t* order,
+                             const uint32_t bucketCount, const uint32_t* grouped,
+                             uint64_t* taken, uint32_t* candidates, uint32_t* displacements) {
+        constexpr uint32_t kMaxDisplacement = 1u << 20;
+
+        std::fill_n(taken, slotCount / 64 + 1, 0ull);
+        std::fill_n(displacements, bucketCount, 0u);
+
+        for (uint32_t k = 0; k < bucketCount; ++k) {
+            const uint32_t bucket = order[k];
+            const uint32_t begin = starts[bucket];
+            const uint32_t count = starts[bucket + 1] - begin;
+            if (count == 0) break; // Sorted by size, so the rest are empty too
+
+            uint32_t displacement = 0;
+            for (; displacement < kMaxDisplacement; ++displacement) {
+                uint32_t placed = 0;
+                for (; placed < count; ++placed) {
+                    const uint32_t slot = arena_perfect_hash_detail::SlotFor(
+                        hashes[grouped[begin + placed]], displacement, slotCount);
+                    if (taken[slot / 64] & (1ull << (slot % 64))) break;
+
+                    // Claim tentatively so keys of the same bucket cannot share a slot.
+                    taken[slot / 64] |= 1ull << (slot % 64);
+                    candidates[placed] = slot;
+                }
+
+                if (placed == count) break;
+
+                for (uint32_t i = 0; i < placed; ++i) {
+                    taken[candidates[i] / 64] &= ~(1ull << (candidates[i] % 64));
+                }
+            }
+
+            if (displacement == kMaxDisplacement) return false;
+            displacements[bucket] = displacement;
+        }
+
+        return true;
+    }
+
+    ArenaAllocator* m_arena; // Holds key copies, the entry list, scratch and the final block
+    ArenaDeque<Entry, 256> m_entries;
+    size_t m_keyBytes = 0; // Total key length, sizes the block's key region
+};
+#endif //ARENA_PERFECT_HASH_H
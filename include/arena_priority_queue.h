@@ -0,0 +1,212 @@
+#pragma once
+#ifndef ARENA_PRIORITY_QUEUE_H
+#define ARENA_PRIORITY_QUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Indexed d-ary min-heap over node ids [0, capacity) with decrease-key
+ *
+ * Every id has a fixed slot in a position table, so DecreaseKey() finds the node in O(1)
+ * and restores the heap in O(log n) instead of pushing duplicates (lazy deletion).
+ * All three tables are allocated from the arena; the heap never frees them itself.
+ */
+template <typename Priority, size_t Arity = 4>
+class ArenaIndexedHeap {
+    static_assert(Arity >= 2, "A d-ary heap needs at least two children per node");
+    static_assert(std::is_trivially_destructible_v<Priority>,
+                  "Priorities are abandoned on arena reset and must be trivially destructible");
+
+public:
+    static constexpr uint32_t kNotInHeap = std::numeric_limits<uint32_t>::max();
+
+    /** @throws std::bad_alloc if the arena cannot hold the tables */
+    ArenaIndexedHeap(ArenaAllocator& arena, const uint32_t capacity) : m_capacity(capacity) {
+        m_heap = arena.AllocArray<uint32_t>(capacity);
+        m_positions = arena.AllocArray<uint32_t>(capacity);
+        m_priorities = arena.AllocArray<Priority>(capacity);
+        if (!m_heap || !m_positions || !m_priorities) throw std::bad_alloc();
+
+        std::fill_n(m_positions, capacity, kNotInHeap);
+    }
+
+    ArenaIndexedHeap(const ArenaIndexedHeap&) = delete;
+    ArenaIndexedHeap& operator=(const ArenaIndexedHeap&) = delete;
+
+    /** @brief Inserts an id that is not currently in the heap */
+    void Push(const uint32_t id, const Priority priority) {
+        m_priorities[id] = priority;
+        SiftUp(m_size++, id);
+    }
+
+    /** @brief Lowers the priority of an id already in the heap */
+    void DecreaseKey(const uint32_t id, const Priority priority) {
+        m_priorities[id] = priority;
+        SiftUp(m_positions[id], id);
+    }
+
+    /**
+     * @brief Inserts the id, or lowers its priority if it is already queued
+     * @return false if the id is queued with an equal or better priority
+     */
+    bool PushOrDecrease(const uint32_t id, const Priority priority) {
+        if (!Contains(id)) {
+            Push(id, priority);
+            return true;
+        }
+
+        if (priority < m_priorities[id]) {
+            DecreaseKey(id, priority);
+            return true;
+        }
+
+        return false;
+    }
+
+    /** @brief Removes and returns the id with the smallest priority */
+    uint32_t Pop() {
+        const uint32_t top = m_heap[0];
+        m_positions[top] = kNotInHeap;
+
+        const uint32_t last = m_heap[--m_size];
+        if (m_size > 0) {
+            SiftDown(0, last);
+        }
+
+        return top;
+    }
+
+    [[nodiscard]] uint32_t Top() const { return m_heap[0]; }
+    [[nodiscard]] Priority TopPriority() const { return m_priorities[m_heap[0]]; }
+    [[nodiscard]] Priority GetPriority(const uint32_t id) const { return m_priorities[id]; }
+
+    [[nodiscard]] bool Contains(const uint32_t id) const { return m_positions[id] != kNotInHeap; }
+    [[nodiscard]] uint32_t Size() const { return m_size; }
+    [[nodiscard]] uint32_t Capacity() const { return m_capacity; }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+private:
+    // Both sifts move a "hole" instead of swapping, writing the moving id only once at the end.
+    void SiftUp(uint32_t hole, const uint32_t id) {
+        const Priority priority = m_priorities[id];
+
+        while (hole > 0) {
+            const uint32_t parent = (hole - 1) / Arity;
+            if (!(priority < m_priorities[m_heap[parent]])) break;
+
+            Place(hole, m_heap[parent]);
+            hole = parent;
+        }
+
+        Place(hole, id);
+    }
+
+    void SiftDown(uint32_t hole, const uint32_t id) {
+        const Priority priority = m_priorities[id];
+
+        for (;;) {
+            const size_t firstChild = static_cast<size_t>(hole) * Arity + 1;
+            if (firstChild >= m_size) break;
+
+            const size_t lastChild = std::min(firstChild + Arity, static_cast<size_t>(m_size));
+            size_t best = firstChild;
+            for (size_t child = firstChild + 1; child < lastChild; ++child) {
+                if (m_priorities[m_heap[child]] < m_priorities[m_heap[best]]) {
+                    best = child;
+                }
+            }
+
+            if (!(m_priorities[m_heap[best]] < priority)) break;
+
+            Place(hole, m_heap[best]);
+            hole = static_cast<uint32_t>(best);
+        }
+
+        Place(hole, id);
+    }
+
+    void Place(const uint32_t slot, const uint32_t id) {
+        m_heap[slot] = id;
+        m_positions[id] = slot;
+    }
+
+    uint32_t* m_heap = nullptr; // Heap order, holds ids
+    uint32_t* m_positions = nullptr; // id -> heap slot, kNotInHeap if absent
+    Priority* m_priorities = nullptr; // id -> current priority
+    uint32_t m_size = 0; // Queued id count
+    uint32_t m_capacity = 0; // Id range
+};
+
+/**
+ * @brief Per-query scratch for Dijkstra/A*: open set plus cost and came-from tables
+ *
+ * Everything is allocated inside an ArenaScope opened by the constructor, so destroying
+ * the query rewinds the arena in O(1) regardless of how many nodes were touched.
+ * @warning Do not keep other allocations from the same arena alive past the query.
+ */
+template <typename Cost, size_t Arity = 4>
+class ArenaPathQuery {
+public:
+    static constexpr uint32_t kNoParent = std::numeric_limits<uint32_t>::max();
+
+    struct NodeRecord {
+        Cost cost; // Best known cost from the start (g)
+        uint32_t parent; // Came-from node, kNoParent for the start or unreached nodes
+    };
+
+    /** @throws std::bad_alloc if the arena cannot hold the tables */
+    ArenaPathQuery(ArenaAllocator& arena, const uint32_t nodeCount)
+        : m_scope(arena), m_open(arena, nodeCount) {
+        m_records = arena.AllocArray<NodeRecord>(nodeCount);
+        if (!m_records) throw std::bad_alloc();
+
+        std::fill_n(m_records, nodeCount, NodeRecord{std::numeric_limits<Cost>::max(), kNoParent});
+    }
+
+    /**
+     * @brief Records a path to node through parent if it is cheaper than the known one
+     * @param priority Open-set key, e.g. cost + heuristic for A*
+     * @return true if the node was improved and (re)queued
+     */
+    bool Relax(const uint32_t node, const uint32_t parent, const Cost cost, const Cost priority) {
+        NodeRecord& record = m_records[node];
+        if (!(cost < record.cost)) return false;
+
+        record.cost = cost;
+        record.parent = parent;
+        m_open.PushOrDecrease(node, priority);
+        return true;
+    }
+
+    /** @brief Relax() for Dijkstra, where the open-set key is the path cost itself */
+    bool Relax(const uint32_t node, const uint32_t parent, const Cost cost) {
+        return Relax(node, parent, cost, cost);
+    }
+
+    /** @brief Walks the came-from chain from target back to the start */
+    template <typename Func>
+    void ForEachPathNode(uint32_t target, Func func) const {
+        for (; target != kNoParent; target = m_records[target].parent) {
+            func(target);
+        }
+    }
+
+    ArenaIndexedHeap<Cost, Arity>& Open() { return m_open; }
+    [[nodiscard]] const NodeRecord& Record(const uint32_t node) const { return m_records[node]; }
+    [[nodiscard]] bool IsReached(const uint32_t node) const {
+        return m_records[node].cost != std::numeric_limits<Cost>::max();
+    }
+
+private:
+    ArenaScope m_scope; // Declared first so it rewinds after everything else is gone
+    ArenaIndexedHeap<Cost, Arity> m_open;
+    NodeRecord* m_records = nullptr;
+};
+#endif //ARENA_PRIORITY_QUEUE_H
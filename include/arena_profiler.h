@@ -0,0 +1,282 @@
+#pragma once
+#ifndef ARENA_PROFILER_H
+#define ARENA_PROFILER_H
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define ARENA_PROFILER_HAS_BACKTRACE 1
+#endif
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Statistical allocation profiler for every ArenaAllocator in the program
+ *
+ * Sampling follows tcmalloc: each arena counts down a geometrically distributed number of
+ * bytes (mean = the sample interval) and captures a stack trace with backtrace() when it runs
+ * out. The countdown is folded into the arena's bounds check, so allocations between samples
+ * cost the same as without the profiler. Samples are aggregated by call stack in a fixed
+ * table, and each one is scaled back up to an unbiased estimate of the bytes it stands for.
+ *
+ * Only allocations are counted; arenas free in bulk, so there is no "in use" view.
+ * @warning Requires ARENA_ENABLE_SAMPLING to be defined for the whole program (the CMake option
+ * of the same name does this). Without it Alloc() has no hook and no samples are ever taken.
+ */
+class ArenaSamplingProfiler {
+public:
+    // A sample costs a few microseconds (backtrace() dominates), and a bump allocator can go
+    // through 512 KB in less time than that; 8 MB keeps sampling under 1% even in a loop that
+    // does nothing but allocate (profiler_benchmark).
+    static constexpr size_t kDefaultSampleInterval = 8 * 1024 * 1024;
+    static constexpr int kMaxFrames = 32;
+    static constexpr size_t kMaxStacks = 4096; // Further distinct stacks are counted as dropped
+
+    /** @brief One distinct call stack and what was sampled there */
+    struct StackRecord {
+        uint64_t hash;
+        void* frames[kMaxFrames]; // Innermost frame first
+        int depth;
+        uint64_t sampleCount;
+        uint64_t sampledBytes; // Raw sizes of the sampled allocations
+        double estimatedCount; // Allocations this stack stands for, after unsampling
+        double estimatedBytes;
+    };
+
+    static ArenaSamplingProfiler& Instance() {
+        static ArenaSamplingProfiler profiler;
+        return profiler;
+    }
+
+    /**
+     * @brief Clears previous samples and starts sampling on all threads
+     * @param sampleInterval Mean number of allocated bytes between two samples
+     * @note Each arena picks the change up within its next 64 KB of allocations.
+     */
+    void Start(const size_t sampleInterval = kDefaultSampleInterval) {
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_table) m_table = std::make_unique<StackRecord[]>(kMaxStacks);
+            ClearLocked();
+            m_sampleInterval = static_cast<double>(sampleInterval);
+        }
+        arena_sampling_detail::g_sampleHook.store(&OnSample, std::memory_order_release);
+    }
+
+    /** @brief Stops taking samples; collected data stays available for the Write functions */
+    void Stop() { arena_sampling_detail::g_sampleHook.store(nullptr, std::memory_order_release); }
+
+    /**
+     * @brief Calls func(const StackRecord&) for every recorded stack
+     * @note Works on a copy taken under the lock, so func may allocate from arenas (and be
+     *       sampled) while sampling is running.
+     */
+    template <typename Func>
+    void ForEachStack(Func func) const {
+        std::vector<StackRecord> records;
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_table) return;
+            for (size_t i = 0; i < kMaxStacks; ++i) {
+                if (m_table[i].sampleCount > 0) records.push_back(m_table[i]);
+            }
+        }
+        for (const StackRecord& record : records) func(record);
+    }
+
+    /**
+     * @brief Writes "root;...;leaf estimatedBytes" lines, the input of flamegraph.pl/inferno
+     * @return false if the file could not be written
+     */
+    bool WriteFolded(const char* path) const {
+        FILE* file = std::fopen(path, "w");
+        if (!file) return false;
+
+        std::string line;
+        ForEachStack([&](const StackRecord& record) {
+            line.clear();
+            for (int i = record.depth - 1; i >= 0; --i) {
+                AppendFrameName(line, record.frames[i]);
+                if (i > 0) line += ';';
+            }
+            if (record.depth == 0) line = "[unknown]";
+            std::fprintf(file, "%s %llu\n", line.c_str(),
+                         static_cast<unsigned long long>(std::llround(record.estimatedBytes)));
+        });
+        return std::fclose(file) == 0;
+    }
+
+    /**
+     * @brief Writes a legacy text heap profile that `pprof <binary> <file>` reads and symbolizes
+     *
+     * The "heap_v2/<interval>" header lets pprof unsample the raw counts itself, so the
+     * allocation columns hold sampled counts and bytes; in-use columns are always zero.
+     * @return false if the file could not be written
+     */
+    bool WritePprof(const char* path) const {
+        FILE* file = std::fopen(path, "w");
+        if (!file) return false;
+
+        uint64_t totalSamples = 0;
+        uint64_t totalBytes = 0;
+        ForEachStack([&](const StackRecord& record) {
+            totalSamples += record.sampleCount;
+            totalBytes += record.sampledBytes;
+        });
+
+        std::fprintf(file, "heap profile: 0: 0 [%llu: %llu] @ heap_v2/%llu\n",
+                     static_cast<unsigned long long>(totalSamples),
+                     static_cast<unsigned long long>(totalBytes),
+                     static_cast<unsigned long long>(m_sampleInterval));
+        ForEachStack([&](const StackRecord& record) {
+            std::fprintf(file, "0: 0 [%llu: %llu] @", static_cast<unsigned long long>(record.sampleCount),
+                         static_cast<unsigned long long>(record.sampledBytes));
+            for (int i = 0; i < record.depth; ++i) std::fprintf(file, " %p", record.frames[i]);
+            std::fputc('\n', file);
+        });
+
+        // pprof needs the load addresses to map frames back to symbols.
+        std::fputs("\nMAPPED_LIBRARIES:\n", file);
+        if (FILE* maps = std::fopen("/proc/self/maps", "r")) {
+            char buffer[4096];
+            size_t read;
+            while ((read = std::fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+                std::fwrite(buffer, 1, read, file);
+            }
+            std::fclose(maps);
+        }
+        return std::fclose(file) == 0;
+    }
+
+    /** @brief Samples that found the stack table full */
+    [[nodiscard]] uint64_t GetDroppedSamples() const {
+        std::lock_guard lock(m_mutex);
+        return m_droppedSamples;
+    }
+
+    [[nodiscard]] uint64_t GetSampleCount() const {
+        std::lock_guard lock(m_mutex);
+        return m_sampleCount;
+    }
+
+private:
+    ArenaSamplingProfiler() = default;
+
+    // Hook called by ArenaAllocator when an arena's countdown runs out.
+    static int64_t OnSample(const size_t size) {
+        ArenaSamplingProfiler& profiler = Instance();
+        void* frames[kMaxFrames + kSkippedFrames];
+        int depth = 0;
+#if defined(ARENA_PROFILER_HAS_BACKTRACE)
+        depth = backtrace(frames, kMaxFrames + kSkippedFrames);
+#endif
+        const int skipped = depth < kSkippedFrames ? depth : kSkippedFrames;
+        const double interval = profiler.Record(frames + skipped, depth - skipped, size);
+        return NextInterval(interval);
+    }
+
+    // Returns the current sample interval, read under the same lock.
+    double Record(void* const* frames, const int depth, const size_t size) {
+        uint64_t hash = 1469598103934665603ull; // FNV-1a over the frame addresses
+        for (int i = 0; i < depth; ++i) {
+            hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+        }
+
+        std::lock_guard lock(m_mutex);
+        ++m_sampleCount;
+
+        // P(an allocation of `size` bytes is sampled) = 1 - exp(-size / interval).
+        const double probability =
+            1.0 - std::exp(-static_cast<double>(size) / m_sampleInterval);
+        const double weight = probability > 0.0 ? 1.0 / probability : 1.0;
+
+        for (size_t probe = 0; probe < kMaxStacks; ++probe) {
+            StackRecord& record = m_table[(hash + probe) & (kMaxStacks - 1)];
+            if (record.sampleCount == 0) {
+                record.hash = hash;
+                record.depth = depth;
+                std::memcpy(record.frames, frames, sizeof(void*) * static_cast<size_t>(depth));
+            } else if (record.hash != hash || record.depth != depth ||
+                       std::memcmp(record.frames, frames, sizeof(void*) * static_cast<size_t>(depth)) != 0) {
+                continue;
+            }
+            ++record.sampleCount;
+            record.sampledBytes += size;
+            record.estimatedCount += weight;
+            record.estimatedBytes += weight * static_cast<double>(size);
+            return m_sampleInterval;
+        }
+        ++m_droppedSamples;
+        return m_sampleInterval;
+    }
+
+    // Geometric (exponential in bytes) gap to the next sample, so that every byte has the same
+    // chance of being sampled and periodic allocation patterns cannot alias with the interval.
+    static int64_t NextInterval(const double interval) {
+        thread_local uint64_t state =
+            0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        // Uniform in (0, 1] from the top 53 bits.
+        const double uniform = static_cast<double>((state >> 11) + 1) * 0x1.0p-53;
+        return static_cast<int64_t>(-std::log(uniform) * interval) + 1;
+    }
+
+    void ClearLocked() {
+        for (size_t i = 0; i < kMaxStacks; ++i) m_table[i] = StackRecord{};
+        m_sampleCount = 0;
+        m_droppedSamples = 0;
+    }
+
+    static void AppendFrameName(std::string& out, void* frame) {
+#if defined(ARENA_PROFILER_HAS_BACKTRACE)
+        // backtrace_symbols() gives "module(mangled+0xoff) [0xaddr]"; keep the function name.
+        char** symbols = backtrace_symbols(&frame, 1);
+        if (symbols) {
+            const char* open = std::strchr(symbols[0], '(');
+            const char* plus = open ? std::strchr(open, '+') : nullptr;
+            if (open && plus && plus > open + 1) {
+                const std::string mangled(open + 1, plus);
+                int status = -1;
+                char* demangled = nullptr;
+#if __has_include(<cxxabi.h>)
+                demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+#endif
+                out += status == 0 && demangled ? demangled : mangled.c_str();
+                std::free(demangled);
+                std::free(symbols);
+                return;
+            }
+            std::free(symbols);
+        }
+#endif
+        char address[2 + 16 + 1];
+        std::snprintf(address, sizeof(address), "%p", frame);
+        out += address;
+    }
+
+    // OnSample() and ArenaAllocator::TakeSample() sit on top of every captured stack.
+    static constexpr int kSkippedFrames = 2;
+
+    mutable std::mutex m_mutex;
+    std::unique_ptr<StackRecord[]> m_table; // Open addressing, kMaxStacks slots
+    double m_sampleInterval = static_cast<double>(kDefaultSampleInterval);
+    uint64_t m_sampleCount = 0;
+    uint64_t m_droppedSamples = 0;
+};
+#endif //ARENA_PROFILER_H
@@ -0,0 +1,544 @@
+#pragma once
+#ifndef ARENA_RADIX_TREE_H
+#define ARENA_RADIX_TREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ARENA_RADIX_TREE_SSE2 1
+#endif
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Adaptive radix tree (ART) whose nodes are allocated from an ArenaAllocator
+ *
+ * Inner nodes adapt between 4, 16, 48 and 256 children, and single-child chains are
+ * collapsed into a compressed prefix. Leaves keep a copy of their full key in the arena;
+ * compressed prefixes point into those copies, so no prefix is ever stored twice.
+ * Keys may be prefixes of each other: such a key lives in the node's terminal slot.
+ *
+ * There is no Erase(): nodes are freed in bulk by resetting the arena. Value must be trivially
+ * destructible, default-constructible and copy-assignable (leaves are value-initialized, then
+ * assigned).
+ * @warning Call Clear() (or drop the tree) whenever the backing arena is Reset().
+ */
+template <typename Value>
+class ArenaRadixTree {
+    static_assert(std::is_trivially_destructible_v<Value>,
+                  "Values are abandoned on arena reset and must be trivially destructible");
+    static_assert(std::is_default_constructible_v<Value> && std::is_copy_assignable_v<Value>,
+                  "Leaves are value-initialized by New<Leaf>() and then assigned the value");
+
+    enum class NodeType : uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+    struct NodeHeader {
+        NodeType type;
+    };
+
+    struct Leaf : NodeHeader {
+        uint32_t keyLength;
+        const uint8_t* key;
+        Value value;
+    };
+
+    struct InnerNode : NodeHeader {
+        uint16_t childCount;
+        uint32_t prefixLength; // Compressed path bytes consumed before the child byte
+        const uint8_t* prefix; // Points into some leaf's key copy
+        Leaf* terminal; // Key that ends exactly at this node, if any
+    };
+
+    struct Node4 : InnerNode {
+        uint8_t keys[4]; // Sorted
+        NodeHeader* children[4];
+    };
+
+    struct Node16 : InnerNode {
+        uint8_t keys[16]; // Sorted
+        NodeHeader* children[16];
+    };
+
+    struct Node48 : InnerNode {
+        uint8_t childIndex[256]; // 0 = empty, otherwise slot + 1
+        NodeHeader* children[48];
+    };
+
+    struct Node256 : InnerNode {
+        NodeHeader* children[256];
+    };
+
+public:
+    explicit ArenaRadixTree(ArenaAllocator& arena) : m_arena(&arena) {}
+
+    ArenaRadixTree(const ArenaRadixTree&) = delete;
+    ArenaRadixTree& operator=(const ArenaRadixTree&) = delete;
+
+    /**
+     * @brief Inserts key if it is not present yet
+     * @return false if the key already exists (its value is left unchanged)
+     * @throws std::bad_alloc if the arena is out of space
+     */
+    bool Insert(const std::string_view key, const Value& value) {
+        const bool inserted = InsertAt(&m_root, Bytes(key), key.size(), 0, value);
+        if (inserted) ++m_size;
+        return inserted;
+    }
+
+    /** @return Pointer to the stored value, or nullptr if the key is absent */
+    [[nodiscard]] Value* Find(const std::string_view key) {
+        const uint8_t* bytes = Bytes(key);
+        const size_t length = key.size();
+        const NodeHeader* node = m_root;
+        size_t depth = 0;
+
+        while (node) {
+            if (node->type == NodeType::Leaf) {
+                Leaf* leaf = AsLeaf(node);
+                return LeafMatches(leaf, bytes, length) ? &leaf->value : nullptr;
+            }
+
+            const InnerNode* inner = static_cast<const InnerNode*>(node);
+            if (!MatchesPrefix(inner, bytes, length, depth)) return nullptr;
+            depth += inner->prefixLength;
+
+            if (depth == length) {
+                return inner->terminal ? &inner->terminal->value : nullptr;
+            }
+
+            NodeHeader* const* child = FindChild(inner, bytes[depth]);
+            node = child ? *child : nullptr;
+            ++depth;
+        }
+
+        return nullptr;
+    }
+
+    [[nodiscard]] const Value* Find(const std::string_view key) const {
+        return const_cast<ArenaRadixTree*>(this)->Find(key);
+    }
+
+    /** @brief Integer keys are stored big-endian so iteration follows numeric order */
+    bool Insert(const uint64_t key, const Value& value) {
+        uint8_t buffer[8];
+        return Insert(EncodeKey(key, buffer), value);
+    }
+
+    [[nodiscard]] Value* Find(const uint64_t key) {
+        uint8_t buffer[8];
+        return Find(EncodeKey(key, buffer));
+    }
+
+    [[nodiscard]] const Value* Find(const uint64_t key) const {
+        return const_cast<ArenaRadixTree*>(this)->Find(key);
+    }
+
+    /**
+     * @brief Value of the longest stored key that is a prefix of key (e.g. URL routing)
+     * @return nullptr if no stored key is a prefix of key
+     */
+    [[nodiscard]] Value* FindLongestPrefix(const std::string_view key) {
+        const uint8_t* bytes = Bytes(key);
+        const size_t length = key.size();
+        const NodeHeader* node = m_root;
+        size_t depth = 0;
+        Value* best = nullptr;
+
+        while (node) {
+            if (node->type == NodeType::Leaf) {
+                Leaf* leaf = AsLeaf(node);
+                if (leaf->keyLength <= length && std::memcmp(leaf->key, bytes, leaf->keyLength) == 0) {
+                    best = &leaf->value;
+                }
+                break;
+            }
+
+            const InnerNode* inner = static_cast<const InnerNode*>(node);
+            if (!MatchesPrefix(inner, bytes, length, depth)) break;
+            depth += inner->prefixLength;
+
+            if (inner->terminal) best = &inner->terminal->value;
+            if (depth == length) break;
+
+            NodeHeader* const* child = FindChild(inner, bytes[depth]);
+            node = child ? *child : nullptr;
+            ++depth;
+        }
+
+        return best;
+    }
+
+    [[nodiscard]] const Value* FindLongestPrefix(const std::string_view key) const {
+        return const_cast<ArenaRadixTree*>(this)->FindLongestPrefix(key);
+    }
+
+    /**
+     * @brief Visits every key starting with prefix, in lexicographic byte order
+     * @param func Called as func(std::string_view key, Value& value)
+     */
+    template <typename Func>
+    void ForEachWithPrefix(const std::string_view prefix, Func func) {
+        const uint8_t* bytes = Bytes(prefix);
+        const size_t length = prefix.size();
+        const NodeHeader* node = m_root;
+        size_t depth = 0;
+
+        while (node) {
+            if (node->type == NodeType::Leaf) {
+                const Leaf* leaf = AsLeaf(node);
+                if (leaf->keyLength >= length && std::memcmp(leaf->key, bytes, length) == 0) {
+                    VisitSubtree(node, func);
+                }
+                return;
+            }
+
+            const InnerNode* inner = static_cast<const InnerNode*>(node);
+            const size_t remaining = length - depth;
+
+            // The prefix may run out in the middle of a compressed path: the whole subtree matches.
+            if (remaining <= inner->prefixLength) {
+                if (std::memcmp(inner->prefix, bytes + depth, remaining) == 0) {
+                    VisitSubtree(node, func);
+                }
+                return;
+            }
+
+            if (std::memcmp(inner->prefix, bytes + depth, inner->prefixLength) != 0) return;
+            depth += inner->prefixLength;
+
+            NodeHeader* const* child = FindChild(inner, bytes[depth]);
+            node = child ? *child : nullptr;
+            ++depth;
+
+            if (node && depth == length) {
+                VisitSubtree(node, func);
+                return;
+            }
+        }
+    }
+
+    /** @brief Const overload: func is called as func(std::string_view key, const Value& value) */
+    template <typename Func>
+    void ForEachWithPrefix(const std::string_view prefix, Func func) const {
+        const_cast<ArenaRadixTree*>(this)->ForEachWithPrefix(
+            prefix, [&](const std::string_view key, const Value& value) { func(key, value); });
+    }
+
+    /** @brief Forgets all keys; the node memory is reclaimed by the arena's Reset() */
+    void Clear() {
+        m_root = nullptr;
+        m_size = 0;
+    }
+
+    [[nodiscard]] size_t Size() const { return m_size; }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+private:
+    static const uint8_t* Bytes(const std::string_view key) {
+        return reinterpret_cast<const uint8_t*>(key.data());
+    }
+
+    static std::string_view EncodeKey(const uint64_t key, uint8_t (&buffer)[8]) {
+        for (int i = 0; i < 8; ++i) {
+            buffer[i] = static_cast<uint8_t>(key >> (56 - 8 * i));
+        }
+        return {reinterpret_cast<const char*>(buffer), 8};
+    }
+
+    static Leaf* AsLeaf(const NodeHeader* node) {
+        return static_cast<Leaf*>(const_cast<NodeHeader*>(node));
+    }
+
+    static bool LeafMatches(const Leaf* leaf, const uint8_t* key, const size_t length) {
+        return leaf->keyLength == length && std::memcmp(leaf->key, key, length) == 0;
+    }
+
+    static bool MatchesPrefix(const InnerNode* node, const uint8_t* key, const size_t length,
+                              const size_t depth) {
+        return length - depth >= node->prefixLength &&
+               std::memcmp(node->prefix, key + depth, node->prefixLength) == 0;
+    }
+
+    template <typename Node>
+    Node* NewNode(const NodeType type) {
+        // Value-initialized, so child slots and the Node48 index start out empty.
+        Node* node = m_arena->New<Node>();
+        if (!node) throw std::bad_alloc();
+        node->type = type;
+        return node;
+    }
+
+    Leaf* NewLeaf(const uint8_t* key, const size_t length, const Value& value) {
+        uint8_t* keyCopy = m_arena->AllocArray<uint8_t>(length);
+        Leaf* leaf = m_arena->New<Leaf>();
+        if ((!keyCopy && length > 0) || !leaf) throw std::bad_alloc();
+
+        std::memcpy(keyCopy, key, length);
+        leaf->type = NodeType::Leaf;
+        leaf->keyLength = static_cast<uint32_t>(length);
+        leaf->key = keyCopy;
+        leaf->value = value;
+        return leaf;
+    }
+
+    bool InsertAt(NodeHeader** ref, const uint8_t* key, const size_t length, size_t depth,
+                  const Value& value) {
+        NodeHeader* node = *ref;
+
+        if (!node) {
+            *ref = NewLeaf(key, length, value);
+            return true;
+        }
+
+        if (node->type == NodeType::Leaf) {
+            Leaf* existing = AsLeaf(node);
+            if (LeafMatches(existing, key, length)) return false;
+
+            // Two keys now share this slot: split on their first differing byte.
+            Leaf* leaf = NewLeaf(key, length, value);
+            const size_t limit = std::min<size_t>(existing->keyLength, length);
+            size_t common = depth;
+            while (common < limit && existing->key[common] == key[common]) ++common;
+
+            Node4* split = NewNode<Node4>(NodeType::Node4);
+            split->prefix = leaf->key + depth;
+            split->prefixLength = static_cast<uint32_t>(common - depth);
+            AttachLeaf(split, existing, common);
+            AttachLeaf(split, leaf, common);
+            *ref = split;
+            return true;
+        }
+
+        InnerNode* inner = static_cast<InnerNode*>(node);
+        if (inner->prefixLength > 0) {
+            const size_t limit = std::min<size_t>(inner->prefixLength, length - depth);
+            size_t mismatch = 0;
+            while (mismatch < limit && inner->prefix[mismatch] == key[depth + mismatch]) ++mismatch;
+
+            if (mismatch < inner->prefixLength) {
+                // The key leaves the compressed path early: cut the path at the mismatch.
+                Node4* split = NewNode<Node4>(NodeType::Node4);
+                split->prefix = inner->prefix;
+                split->prefixLength = static_cast<uint32_t>(mismatch);
+
+                const uint8_t branch = inner->prefix[mismatch];
+                inner->prefix += mismatch + 1;
+                inner->prefixLength -= static_cast<uint32_t>(mismatch + 1);
+
+                NodeHeader* asHeader = split;
+                AddChild(&asHeader, branch, inner);
+                AttachLeaf(split, NewLeaf(key, length, value), depth + mismatch);
+                *ref = split;
+                return true;
+            }
+
+            depth += inner->prefixLength;
+        }
+
+        if (depth == length) {
+            if (inner->terminal) return false;
+            inner->terminal = NewLeaf(key, length, value);
+            return true;
+        }
+
+        if (NodeHeader** child = FindChild(inner, key[depth])) {
+            return InsertAt(child, key, length, depth + 1, value);
+        }
+
+        AddChild(ref, key[depth], NewLeaf(key, length, value));
+        return true;
+    }
+
+    // Hangs a leaf off a freshly split node: as its terminal, or under the byte at depth.
+    void AttachLeaf(Node4* node, Leaf* leaf, const size_t depth) {
+        if (depth == leaf->keyLength) {
+            node->terminal = leaf;
+        } else {
+            NodeHeader* asHeader = node;
+            AddChild(&asHeader, leaf->key[depth], leaf);
+        }
+    }
+
+    static NodeHeader** FindChild(const InnerNode* inner, const uint8_t byte) {
+        switch (inner->type) {
+            case NodeType::Node4: {
+                auto* node = static_cast<Node4*>(const_cast<InnerNode*>(inner));
+                for (uint16_t i = 0; i < node->childCount; ++i) {
+                    if (node->keys[i] == byte) return &node->children[i];
+                }
+                return nullptr;
+            }
+            case NodeType::Node16: {
+                auto* node = static_cast<Node16*>(const_cast<InnerNode*>(inner));
+#ifdef ARENA_RADIX_TREE_SSE2
+                // Compare all 16 key bytes at once; mask off slots past childCount.
+                const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys));
+                const __m128i match = _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(byte)));
+                const unsigned mask =
+                    static_cast<unsigned>(_mm_movemask_epi8(match)) & ((1u << node->childCount) - 1);
+                return mask ? &node->children[__builtin_ctz(mask)] : nullptr;
+#else
+                for (uint16_t i = 0; i < node->childCount; ++i) {
+                    if (node->keys[i] == byte) return &node->children[i];
+                }
+                return nullptr;
+#endif
+            }
+            case NodeType::Node48: {
+                auto* node = static_cast<Node48*>(const_cast<InnerNode*>(inner));
+                const uint8_t slot = node->childIndex[byte];
+                return slot ? &node->children[slot - 1] : nullptr;
+            }
+            case NodeType::Node256: {
+                auto* node = static_cast<Node256*>(const_cast<InnerNode*>(inner));
+                return node->children[byte] ? &node->children[byte] : nullptr;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    // Inserts into a sorted key/child array pair of a Node4 or Node16 with spare room.
+    template <typename Node>
+    static void InsertSorted(Node* node, const uint8_t byte, NodeHeader* child) {
+        uint16_t position = 0;
+        while (position < node->childCount && node->keys[position] < byte) ++position;
+
+        const uint16_t tail = node->childCount - position;
+        std::memmove(node->keys + position + 1, node->keys + position, tail);
+        std::memmove(node->children + position + 1, node->children + position,
+                     tail * sizeof(NodeHeader*));
+        node->keys[position] = byte;
+        node->children[position] = child;
+        ++node->childCount;
+    }
+
+    template <typename To>
+    To* Grow(const InnerNode* from, const NodeType type) {
+        To* node = NewNode<To>(type);
+        node->childCount = from->childCount;
+        node->prefixLength = from->prefixLength;
+        node->prefix = from->prefix;
+        node->terminal = from->terminal;
+        return node;
+    }
+
+    // Adds a child under byte, replacing *ref with a larger node type when the current one is full.
+    // The outgrown node is simply abandoned in the arena.
+    void AddChild(NodeHeader** ref, const uint8_t byte, NodeHeader* child) {
+        InnerNode* inner = static_cast<InnerNode*>(*ref);
+
+        switch (inner->type) {
+            case NodeType::Node4: {
+                auto* node = static_cast<Node4*>(inner);
+                if (node->childCount < 4) {
+                    InsertSorted(node, byte, child);
+                    return;
+                }
+
+                Node16* grown = Grow<Node16>(node, NodeType::Node16);
+                std::memcpy(grown->keys, node->keys, sizeof(node->keys));
+                std::memcpy(grown->children, node->children, sizeof(node->children));
+                InsertSorted(grown, byte, child);
+                *ref = grown;
+                return;
+            }
+            case NodeType::Node16: {
+                auto* node = static_cast<Node16*>(inner);
+                if (node->childCount < 16) {
+                    InsertSorted(node, byte, child);
+                    return;
+                }
+
+                Node48* grown = Grow<Node48>(node, NodeType::Node48);
+                std::memcpy(grown->children, node->children, sizeof(node->children));
+                for (uint8_t i = 0; i < 16; ++i) {
+                    grown->childIndex[node->keys[i]] = i + 1;
+                }
+                *ref = grown;
+                AddChild(ref, byte, child);
+                return;
+            }
+            case NodeType::Node48: {
+                auto* node = static_cast<Node48*>(inner);
+                if (node->childCount < 48) {
+                    node->children[node->childCount] = child;
+                    node->childIndex[byte] = static_cast<uint8_t>(++node->childCount);
+                    return;
+                }
+
+                Node256* grown = Grow<Node256>(node, NodeType::Node256);
+                for (int b = 0; b < 256; ++b) {
+                    if (node->childIndex[b]) {
+                        grown->children[b] = node->children[node->childIndex[b] - 1];
+                    }
+                }
+                *ref = grown;
+                AddChild(ref, byte, child);
+                return;
+            }
+            case NodeType::Node256: {
+                auto* node = static_cast<Node256*>(inner);
+                node->children[byte] = child;
+                ++node->childCount;
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    template <typename Func>
+    static void VisitSubtree(const NodeHeader* node, Func& func) {
+        if (node->type == NodeType::Leaf) {
+            Leaf* leaf = AsLeaf(node);
+            func(std::string_view(reinterpret_cast<const char*>(leaf->key), leaf->keyLength),
+                 leaf->value);
+            return;
+        }
+
+        const InnerNode* inner = static_cast<const InnerNode*>(node);
+        if (inner->terminal) VisitSubtree(inner->terminal, func);
+
+        switch (inner->type) {
+            case NodeType::Node4: {
+                const auto* n = static_cast<const Node4*>(inner);
+                for (uint16_t i = 0; i < n->childCount; ++i) VisitSubtree(n->children[i], func);
+                break;
+            }
+            case NodeType::Node16: {
+                const auto* n = static_cast<const Node16*>(inner);
+                for (uint16_t i = 0; i < n->childCount; ++i) VisitSubtree(n->children[i], func);
+                break;
+            }
+            case NodeType::Node48: {
+                const auto* n = static_cast<const Node48*>(inner);
+                for (int b = 0; b < 256; ++b) {
+                    if (n->childIndex[b]) VisitSubtree(n->children[n->childIndex[b] - 1], func);
+                }
+                break;
+            }
+            case NodeType::Node256: {
+                const auto* n = static_cast<const Node256*>(inner);
+                for (int b = 0; b < 256; ++b) {
+                    if (n->children[b]) VisitSubtree(n->children[b], func);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    ArenaAllocator* m_arena; // Node source
+    NodeHeader* m_root = nullptr;
+    size_t m_size = 0; // Stored key count
+};
+#endif //ARENA_RADIX_TREE_H
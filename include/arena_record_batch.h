@@ -0,0 +1,231 @@
+#pragma once
+#ifndef ARENA_RECORD_BATCH_H
+#define ARENA_RECORD_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "arena_allocator.h"
+#include "arena_string_table.h"
+
+enum class ColumnType : uint8_t { Int32, Int64, Float32, Float64, String };
+
+struct ColumnSchema {
+    std::string_view name;
+    ColumnType type;
+    bool nullable = false; // Only nullable columns get a validity bitmap
+};
+
+namespace arena_record_batch_detail {
+
+constexpr size_t kColumnAlign = 64;
+
+template <typename T>
+constexpr ColumnType ColumnTypeOf() {
+    if constexpr (std::is_same_v<T, int32_t>) return ColumnType::Int32;
+    else if constexpr (std::is_same_v<T, int64_t>) return ColumnType::Int64;
+    else if constexpr (std::is_same_v<T, float>) return ColumnType::Float32;
+    else if constexpr (std::is_same_v<T, double>) return ColumnType::Float64;
+    else static_assert(sizeof(T) == 0, "Unsupported fixed-width column type");
+}
+
+inline size_t WidthOf(const ColumnType type) {
+    switch (type) {
+        case ColumnType::Int32:
+        case ColumnType::Float32: return 4;
+        case ColumnType::Int64:
+        case ColumnType::Float64: return 8;
+        case ColumnType::String: return 0;
+    }
+    return 0;
+}
+
+inline size_t AlignUp(const size_t value, const size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+} // namespace arena_record_batch_detail
+
+/**
+ * @brief Columnar batch of rows (Arrow-like layout) allocated entirely from one arena
+ *
+ * Fixed-width columns are plain arrays; string columns are ArenaStringTables (offsets plus
+ * one byte buffer); nullable columns add a validity bitmap with bit (row % 64) of word
+ * (row / 64) set for non-null rows. Every array is 64-byte aligned. Value arrays and bitmaps
+ * are also padded to a multiple of 64 bytes, so vector loops may read whole registers past
+ * RowCount() without faulting.
+ *
+ * Columns are filled in place (Values<T>(), Strings(), SetNull()) and then published with
+ * SetRowCount(), so ingesting a row allocates nothing. Every part of the batch is trivially
+ * destructible: drop it by resetting (or rewinding) the arena.
+ * @warning The batch must not outlive the arena region it was allocated in.
+ */
+class ArenaRecordBatch {
+public:
+    /**
+     * @param capacity Rows every fixed-width column and bitmap is sized for
+     * @param stringBytesPerRow Initial byte capacity of each string column, per row
+     * @throws std::invalid_argument if the schema is empty
+     * @throws std::bad_alloc if the arena is out of space
+     */
+    ArenaRecordBatch(ArenaAllocator& arena, const std::span<const ColumnSchema> schema,
+                     const uint32_t capacity, const size_t stringBytesPerRow = 16)
+        : m_capacity(capacity), m_columnCount(static_cast<uint32_t>(schema.size())) {
+        using namespace arena_record_batch_detail;
+        if (schema.empty()) throw std::invalid_argument("ArenaRecordBatch: empty schema");
+
+        m_columns = arena.AllocArray<Column>(schema.size());
+        if (!m_columns) throw std::bad_alloc();
+
+        const size_t bitmapBytes = AlignUp((capacity + 7) / 8, kColumnAlign);
+        for (size_t i = 0; i < schema.size(); ++i) {
+            Column& column = *new (&m_columns[i]) Column{};
+            column.type = schema[i].type;
+            column.name = CopyName(arena, schema[i].name);
+
+            if (schema[i].nullable) {
+                column.validity = static_cast<uint64_t*>(arena.Alloc(bitmapBytes, kColumnAlign));
+                if (!column.validity) throw std::bad_alloc();
+                std::memset(column.validity, 0xFF, bitmapBytes); // Rows start out valid
+            }
+
+            if (column.type == ColumnType::String) {
+                column.strings = arena.New<ArenaStringTable>(arena);
+                if (!column.strings) throw std::bad_alloc();
+                column.strings->Reserve(capacity, capacity * stringBytesPerRow);
+            } else {
+                const size_t bytes = AlignUp(capacity * WidthOf(column.type), kColumnAlign);
+                column.values = arena.Alloc(bytes ? bytes : kColumnAlign, kColumnAlign);
+                if (!column.values) throw std::bad_alloc();
+            }
+        }
+    }
+
+    /**
+     * @brief Value array of a fixed-width column, Capacity() entries
+     * @throws std::invalid_argument if the column does not hold T
+     */
+    template <typename T>
+    [[nodiscard]] T* Values(const uint32_t column) {
+        if (m_columns[column].type != arena_record_batch_detail::ColumnTypeOf<T>()) {
+            throw std::invalid_argument("ArenaRecordBatch: column type mismatch");
+        }
+        return static_cast<T*>(m_columns[column].values);
+    }
+
+    template <typename T>
+    [[nodiscard]] const T* Values(const uint32_t column) const {
+        return const_cast<ArenaRecordBatch*>(this)->Values<T>(column);
+    }
+
+    /**
+     * @brief Strings of a string column; append exactly one (empty for null) per row
+     * @throws std::invalid_argument if the column is not a string column
+     */
+    [[nodiscard]] ArenaStringTable& Strings(const uint32_t column) {
+        if (!m_columns[column].strings) {
+            throw std::invalid_argument("ArenaRecordBatch: not a string column");
+        }
+        return *m_columns[column].strings;
+    }
+
+    [[nodiscard]] const ArenaStringTable& Strings(const uint32_t column) const {
+        return const_cast<ArenaRecordBatch*>(this)->Strings(column);
+    }
+
+    /** @brief Validity bitmap, or nullptr for a non-nullable column (every row valid) */
+    [[nodiscard]] uint64_t* Validity(const uint32_t column) { return m_columns[column].validity; }
+    [[nodiscard]] const uint64_t* Validity(const uint32_t column) const {
+        return m_columns[column].validity;
+    }
+
+    /** @throws std::invalid_argument if the column is not nullable */
+    void SetNull(const uint32_t column, const uint32_t row) {
+        uint64_t* validity = m_columns[column].validity;
+        if (!validity) throw std::invalid_argument("ArenaRecordBatch: column is not nullable");
+        validity[row / 64] &= ~(uint64_t{1} << (row % 64));
+    }
+
+    [[nodiscard]] bool IsValid(const uint32_t column, const uint32_t row) const {
+        const uint64_t* validity = m_columns[column].validity;
+        return !validity || (validity[row / 64] >> (row % 64)) & 1;
+    }
+
+    /** @brief Null rows among the first RowCount(), by popcount over the bitmap */
+    [[nodiscard]] uint32_t CountNulls(const uint32_t column) const {
+        const uint64_t* validity = m_columns[column].validity;
+        if (!validity) return 0;
+
+        uint32_t valid = 0;
+        const uint32_t fullWords = m_rowCount / 64;
+        for (uint32_t w = 0; w < fullWords; ++w) valid += __builtin_popcountll(validity[w]);
+        if (m_rowCount % 64) {
+            const uint64_t mask = (uint64_t{1} << (m_rowCount % 64)) - 1;
+            valid += __builtin_popcountll(validity[fullWords] & mask);
+        }
+        return m_rowCount - valid;
+    }
+
+    /**
+     * @brief Publishes the first count rows as filled in
+     * @throws std::invalid_argument if count exceeds Capacity() or a string column does not
+     *         hold exactly count strings
+     */
+    void SetRowCount(const uint32_t count) {
+        if (count > m_capacity) throw std::invalid_argument("ArenaRecordBatch: over capacity");
+        for (uint32_t c = 0; c < m_columnCount; ++c) {
+            if (m_columns[c].strings && m_columns[c].strings->Size() != count) {
+                throw std::invalid_argument("ArenaRecordBatch: string column row count mismatch");
+            }
+        }
+        m_rowCount = count;
+    }
+
+    /** @return Index of the column called name, or -1 */
+    [[nodiscard]] int FindColumn(const std::string_view name) const {
+        for (uint32_t c = 0; c < m_columnCount; ++c) {
+            if (m_columns[c].name == name) return static_cast<int>(c);
+        }
+        return -1;
+    }
+
+    [[nodiscard]] ColumnType GetColumnType(const uint32_t column) const {
+        return m_columns[column].type;
+    }
+    [[nodiscard]] std::string_view GetColumnName(const uint32_t column) const {
+        return m_columns[column].name;
+    }
+
+    [[nodiscard]] uint32_t RowCount() const { return m_rowCount; }
+    [[nodiscard]] uint32_t Capacity() const { return m_capacity; }
+    [[nodiscard]] uint32_t ColumnCount() const { return m_columnCount; }
+
+private:
+    struct Column {
+        ColumnType type;
+        std::string_view name; // Copied into the arena
+        void* values = nullptr; // Fixed-width columns
+        uint64_t* validity = nullptr; // Nullable columns
+        ArenaStringTable* strings = nullptr; // String columns
+    };
+
+    static std::string_view CopyName(ArenaAllocator& arena, const std::string_view name) {
+        if (name.empty()) return {};
+        auto* copy = arena.AllocArray<char>(name.size());
+        if (!copy) throw std::bad_alloc();
+        std::memcpy(copy, name.data(), name.size());
+        return {copy, name.size()};
+    }
+
+    Column* m_columns = nullptr; // Arena array, one per schema entry
+    uint32_t m_capacity;
+    uint32_t m_columnCount;
+    uint32_t m_rowCount = 0;
+};
+#endif //ARENA_RECORD_BATCH_H
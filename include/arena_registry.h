@@ -0,0 +1,415 @@
+#pragma once
+#ifndef ARENA_REGISTRY_H
+#define ARENA_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "arena_allocator.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define ARENA_REGISTRY_HAS_SERVER 1
+#endif
+
+/** @brief Point-in-time view of one registered arena */
+struct ArenaStats {
+    const char* name;
+    const void* address; // The ArenaAllocator object, to tell same-named arenas apart
+    size_t totalSize;
+    size_t usedMemory;
+    size_t highWaterMark;
+    size_t blockCount; // ArenaAllocator owns one fixed block; 0 once moved from
+};
+
+class ArenaRegistry;
+
+/**
+ * @brief Lists an arena in the global ArenaRegistry for as long as this object lives
+ *
+ * Registering takes the registry lock once here and once in the destructor; the arena's own
+ * Alloc()/Reset() paths are untouched.
+ * @warning Must not outlive the arena, and the arena must not be moved while registered.
+ */
+class ArenaRegistration {
+public:
+    static constexpr size_t kMaxNameLength = 63;
+
+    /** @param name Label shown in dumps, truncated to kMaxNameLength bytes */
+    ArenaRegistration(const ArenaAllocator& arena, std::string_view name);
+    ~ArenaRegistration();
+
+    ArenaRegistration(const ArenaRegistration&) = delete;
+    ArenaRegistration& operator=(const ArenaRegistration&) = delete;
+
+private:
+    friend class ArenaRegistry;
+
+    const ArenaAllocator* m_arena;
+    char m_name[kMaxNameLength + 1]; // NUL-terminated copy
+    ArenaRegistration* m_prev = nullptr; // Intrusive list, guarded by the registry lock
+    ArenaRegistration* m_next = nullptr;
+};
+
+/**
+ * @brief Process-wide list of live, registered arenas
+ *
+ * Readers walk the list under a lock, but each arena's counters are plain members read
+ * without synchronizing with the thread that owns it (making them atomic would tax every
+ * Alloc()). Reading them while that thread allocates or rewinds is a data race, not just a
+ * stale value.
+ * @warning Take snapshots (ForEach(), ToJson(), and so the dumps of ArenaIntrospectionServer)
+ *          only while the threads owning registered arenas are quiescent, e.g. parked between
+ *          frames; ThreadSanitizer reports any other dump.
+ */
+class ArenaRegistry {
+public:
+    static ArenaRegistry& Instance() {
+        static ArenaRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Calls func(const ArenaStats&) for every registered arena, oldest first
+     * @warning The arenas' owning threads must be quiescent (see the class comment).
+     */
+    template <typename Func>
+    void ForEach(Func func) const {
+        std::lock_guard lock(m_mutex);
+        for (const ArenaRegistration* entry = m_tail; entry; entry = entry->m_prev) {
+            const ArenaAllocator& arena = *entry->m_arena;
+            func(ArenaStats{entry->m_name, entry->m_arena, arena.GetTotalSize(),
+                            arena.GetUsedMemory(), arena.GetHighWaterMark(),
+                            arena.GetTotalSize() > 0 ? size_t{1} : size_t{0}});
+        }
+    }
+
+    [[nodiscard]] size_t Size() const {
+        std::lock_guard lock(m_mutex);
+        return m_count;
+    }
+
+    /**
+     * @brief Renders all registered arenas as one JSON object
+     *
+     * {"pid":..,"arenas":[{"name":..,"address":..,"totalSize":..,"usedMemory":..,
+     * "highWaterMark":..,"blockCount":..}, ...]}
+     */
+    [[nodiscard]] std::string ToJson() const {
+        std::string json = "{\"pid\":";
+#if defined(ARENA_REGISTRY_HAS_SERVER)
+        json += std::to_string(static_cast<long long>(getpid()));
+#else
+        json += "null";
+#endif
+        json += ",\"arenas\":[";
+
+        bool first = true;
+        ForEach([&](const ArenaStats& stats) {
+            if (!first) json += ',';
+            first = false;
+
+            char address[2 + 16 + 1];
+            std::snprintf(address, sizeof(address), "%p", stats.address);
+
+            json += "{\"name\":\"";
+            AppendEscaped(json, stats.name);
+            json += "\",\"address\":\"";
+            json += address;
+            json += "\",\"totalSize\":" + std::to_string(stats.totalSize);
+            json += ",\"usedMemory\":" + std::to_string(stats.usedMemory);
+            json += ",\"highWaterMark\":" + std::to_string(stats.highWaterMark);
+            json += ",\"blockCount\":" + std::to_string(stats.blockCount);
+            json += '}';
+        });
+
+        json += "]}\n";
+        return json;
+    }
+
+private:
+    friend class ArenaRegistration;
+
+    ArenaRegistry() = default;
+
+    void Link(ArenaRegistration* entry) {
+        std::lock_guard lock(m_mutex);
+        entry->m_next = m_head;
+        if (m_head) m_head->m_prev = entry;
+        else m_tail = entry;
+        m_head = entry;
+        ++m_count;
+    }
+
+    void Unlink(ArenaRegistration* entry) {
+        std::lock_guard lock(m_mutex);
+        if (entry->m_prev) entry->m_prev->m_next = entry->m_next;
+        else m_head = entry->m_next;
+        if (entry->m_next) entry->m_next->m_prev = entry->m_prev;
+        else m_tail = entry->m_prev;
+        --m_count;
+    }
+
+    static void AppendEscaped(std::string& out, const char* text) {
+        for (; *text; ++text) {
+            const auto c = static_cast<unsigned char>(*text);
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += static_cast<char>(c);
+            } else if (c < 0x20) {
+                char escaped[7];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    ArenaRegistration* m_head = nullptr; // Newest registration
+    ArenaRegistration* m_tail = nullptr; // Oldest registration
+    size_t m_count = 0;
+};
+
+inline ArenaRegistration::ArenaRegistration(const ArenaAllocator& arena, const std::string_view name)
+    : m_arena(&arena) {
+    const size_t length = name.size() < kMaxNameLength ? name.size() : kMaxNameLength;
+    name.copy(m_name, length);
+    m_name[length] = '\0';
+    ArenaRegistry::Instance().Link(this);
+}
+
+inline ArenaRegistration::~ArenaRegistration() {
+    ArenaRegistry::Instance().Unlink(this);
+}
+
+#if defined(ARENA_REGISTRY_HAS_SERVER)
+
+namespace arena_registry_detail {
+
+// Write end of the running server's wake-up pipe, for the signal handler.
+inline std::atomic<int> g_signalPipe{-1};
+
+// Async-signal-safe: only write() to the pipe, the server thread does the dump.
+inline void OnDumpSignal(int) {
+    const int savedErrno = errno;
+    const int fd = g_signalPipe.load(std::memory_order_relaxed);
+    if (fd >= 0) (void)!write(fd, "d", 1);
+    errno = savedErrno;
+}
+
+} // namespace arena_registry_detail
+
+/** @brief Where ArenaIntrospectionServer publishes the registry; null disables a channel */
+struct ArenaIntrospectionOptions {
+    const char* dumpPath = nullptr; // SIGUSR1 writes the JSON here (atomically, via rename)
+    const char* socketPath = nullptr; // UNIX socket; every connection receives the JSON
+};
+
+/**
+ * @brief Background thread that serves ArenaRegistry::ToJson() on demand
+ *
+ *     kill -USR1 <pid> && cat /tmp/arenas.json
+ *     socat - UNIX-CONNECT:/tmp/arenas.sock
+ *
+ * The thread sleeps in poll() until a signal or a client arrives, so an idle server costs
+ * nothing. Only one server may handle SIGUSR1 at a time.
+ */
+class ArenaIntrospectionServer {
+public:
+    /** @throws std::runtime_error if the pipe, socket or signal handler cannot be set up */
+    explicit ArenaIntrospectionServer(const ArenaIntrospectionOptions& options)
+        : m_options(options) {
+        int fds[2];
+        if (pipe(fds) != 0) throw std::runtime_error("ArenaIntrospectionServer: pipe failed");
+        m_wakeRead = fds[0];
+        m_wakeWrite = fds[1];
+        fcntl(m_wakeWrite, F_SETFL, O_NONBLOCK); // The signal handler must never block
+        fcntl(m_wakeRead, F_SETFD, FD_CLOEXEC);
+        fcntl(m_wakeWrite, F_SETFD, FD_CLOEXEC);
+
+        try {
+            if (m_options.socketPath) OpenSocket();
+            if (m_options.dumpPath) InstallSignalHandler();
+        } catch (...) {
+            CloseAll();
+            throw;
+        }
+
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    /** @brief Restores the previous SIGUSR1 handler, stops the thread, removes the socket */
+    ~ArenaIntrospectionServer() {
+        if (m_signalInstalled) {
+            sigaction(SIGUSR1, &m_previousAction, nullptr);
+            arena_registry_detail::g_signalPipe.store(-1, std::memory_order_relaxed);
+        }
+        (void)!write(m_wakeWrite, "q", 1);
+        m_thread.join();
+        CloseAll();
+    }
+
+    ArenaIntrospectionServer(const ArenaIntrospectionServer&) = delete;
+    ArenaIntrospectionServer& operator=(const ArenaIntrospectionServer&) = delete;
+
+    /** @brief Signal-triggered dumps written so far */
+    [[nodiscard]] uint64_t GetDumpCount() const { return m_dumpCount.load(); }
+
+private:
+    void OpenSocket() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (std::string_view(m_options.socketPath).size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("ArenaIntrospectionServer: socket path too long");
+        }
+        std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", m_options.socketPath);
+
+        m_listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_listenSocket < 0) throw std::runtime_error("ArenaIntrospectionServer: socket failed");
+        fcntl(m_listenSocket, F_SETFD, FD_CLOEXEC);
+
+        // A stale socket from a crashed run would block bind(). Anything else at that path is
+        // not ours to delete; bind() then fails and so does the constructor.
+        struct stat existing{};
+        if (lstat(m_options.socketPath, &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+            unlink(m_options.socketPath);
+        }
+        if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(m_listenSocket, 4) != 0) {
+            throw std::runtime_error("ArenaIntrospectionServer: cannot listen on socket");
+        }
+        m_socketBound = true;
+    }
+
+    void InstallSignalHandler() {
+        int expected = -1;
+        if (!arena_registry_detail::g_signalPipe.compare_exchange_strong(expected, m_wakeWrite)) {
+            throw std::runtime_error("ArenaIntrospectionServer: SIGUSR1 is already handled");
+        }
+
+        struct sigaction action{};
+        action.sa_handler = &arena_registry_detail::OnDumpSignal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (sigaction(SIGUSR1, &action, &m_previousAction) != 0) {
+            arena_registry_detail::g_signalPipe.store(-1);
+            throw std::runtime_error("ArenaIntrospectionServer: sigaction failed");
+        }
+        m_signalInstalled = true;
+    }
+
+    void Run() {
+        pollfd fds[2] = {{m_wakeRead, POLLIN, 0}, {m_listenSocket, POLLIN, 0}};
+        const nfds_t count = m_listenSocket >= 0 ? 2 : 1;
+
+        for (;;) {
+            if (poll(fds, count, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                char commands[64];
+                const ssize_t read = ::read(m_wakeRead, commands, sizeof(commands));
+                bool dump = false;
+                for (ssize_t i = 0; i < read; ++i) {
+                    if (commands[i] == 'q') return;
+                    dump = true;
+                }
+                if (dump) WriteDump();
+            }
+
+            if (count > 1 && (fds[1].revents & POLLIN)) {
+                const int client = accept(m_listenSocket, nullptr, nullptr);
+                if (client >= 0) {
+                    SendAll(client, ArenaRegistry::Instance().ToJson());
+                    close(client);
+                }
+            }
+        }
+    }
+
+    // Writes to "<path>.tmp" and renames, so readers never see a half-written file.
+    void WriteDump() {
+        const std::string json = ArenaRegistry::Instance().ToJson();
+        const std::string temporary = std::string(m_options.dumpPath) + ".tmp";
+
+        FILE* file = std::fopen(temporary.c_str(), "w");
+        if (!file) return;
+        const bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+        if (std::fclose(file) == 0 && written &&
+            std::rename(temporary.c_str(), m_options.dumpPath) == 0) {
+            m_dumpCount.fetch_add(1);
+        }
+    }
+
+    // Non-blocking sends under one deadline for the whole reply: a client that connects and
+    // never reads is dropped instead of stalling every later dump and the destructor's join().
+    static void SendAll(const int fd, const std::string& text) {
+#if defined(MSG_NOSIGNAL)
+        constexpr int kFlags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+        constexpr int kFlags = MSG_DONTWAIT;
+#endif
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(kClientTimeoutMs);
+        size_t sent = 0;
+        while (sent < text.size()) {
+            const ssize_t n = send(fd, text.data() + sent, text.size() - sent, kFlags);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return; // Client went away
+
+            const long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            pollfd writable{fd, POLLOUT, 0};
+            if (remaining <= 0 || poll(&writable, 1, static_cast<int>(remaining)) <= 0) {
+                return; // Too slow: drop the client
+            }
+        }
+    }
+
+    void CloseAll() {
+        if (m_listenSocket >= 0) close(m_listenSocket);
+        if (m_socketBound) unlink(m_options.socketPath);
+        close(m_wakeRead);
+        close(m_wakeWrite);
+    }
+
+    static constexpr int kClientTimeoutMs = 250; // Per socket client, for the whole reply
+
+    ArenaIntrospectionOptions m_options;
+    int m_wakeRead = -1; // Self-pipe: 'd' = dump (from the signal handler), 'q' = quit
+    int m_wakeWrite = -1;
+    int m_listenSocket = -1;
+    bool m_socketBound = false;
+    bool m_signalInstalled = false;
+    struct sigaction m_previousAction{};
+    std::atomic<uint64_t> m_dumpCount{0};
+    std::thread m_thread; // Started last, once every descriptor above is ready
+};
+
+#endif
+
+#endif //ARENA_REGISTRY_H
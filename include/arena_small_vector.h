@@ -0,0 +1,198 @@
+#pragma once
+#ifndef ARENA_SMALL_VECTOR_H
+#define ARENA_SMALL_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Vector with N inline elements that spills into an ArenaAllocator
+ * @warning Spilled storage is only reclaimed by the arena's Reset()/ResetToMarker().
+ *          The vector must not outlive the arena region it spilled into.
+ */
+template <typename T, size_t N>
+class ArenaSmallVector {
+    static_assert(N > 0, "ArenaSmallVector needs at least one inline element");
+
+public:
+    explicit ArenaSmallVector(ArenaAllocator& arena) : m_arena(&arena) {}
+
+    ~ArenaSmallVector() {
+        // Elements are destroyed, but spilled memory stays in the arena until it is reset.
+        std::destroy_n(m_data, m_size);
+    }
+
+    ArenaSmallVector(const ArenaSmallVector&) = delete;
+    ArenaSmallVector& operator=(const ArenaSmallVector&) = delete;
+
+    // Move Constructor
+    // Inline elements are moved one by one, so this is only as noexcept as T's move.
+    ArenaSmallVector(ArenaSmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : m_arena(other.m_arena) {
+        StealFrom(other);
+    }
+
+    // Assign operator
+    ArenaSmallVector& operator=(ArenaSmallVector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            std::destroy_n(m_data, m_size);
+            m_arena = other.m_arena;
+            m_data = InlineData();
+            m_size = 0;
+            m_capacity = N;
+            StealFrom(other);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Constructs an element at the end
+     * @throws std::bad_alloc if the vector has to spill and the arena is out of space
+     */
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (m_size == m_capacity) {
+            return GrowAndEmplaceBack(std::forward<Args>(args)...);
+        }
+
+        T* slot = new (m_data + m_size) T(std::forward<Args>(args)...);
+        ++m_size;
+        return *slot;
+    }
+
+    void PushBack(const T& value) { EmplaceBack(value); }
+    void PushBack(T&& value) { EmplaceBack(std::move(value)); }
+
+    void PopBack() {
+        --m_size;
+        std::destroy_at(m_data + m_size);
+    }
+
+    /** @brief Destroys all elements, keeping the current capacity */
+    void Clear() {
+        std::destroy_n(m_data, m_size);
+        m_size = 0;
+    }
+
+    /** @throws std::bad_alloc if the arena cannot provide the requested capacity */
+    void Reserve(const size_t capacity) {
+        if (capacity > m_capacity) {
+            Grow(capacity);
+        }
+    }
+
+    T& operator[](const size_t index) { return m_data[index]; }
+    const T& operator[](const size_t index) const { return m_data[index]; }
+
+    T& Back() { return m_data[m_size - 1]; }
+    const T& Back() const { return m_data[m_size - 1]; }
+
+    T* Data() { return m_data; }
+    const T* Data() const { return m_data; }
+
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+
+    [[nodiscard]] size_t Size() const { return m_size; }
+    [[nodiscard]] size_t Capacity() const { return m_capacity; }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+    /** @brief True while elements still live in the inline buffer */
+    [[nodiscard]] bool IsInline() const { return m_data == InlineData(); }
+
+private:
+    T* InlineData() { return std::launder(reinterpret_cast<T*>(m_inline)); }
+    const T* InlineData() const { return std::launder(reinterpret_cast<const T*>(m_inline)); }
+
+    void Grow(const size_t newCapacity) {
+        if (TryGrowInPlace(newCapacity)) return;
+
+        T* newData = AllocStorage(newCapacity);
+        MoveInto(newData, newCapacity);
+    }
+
+    // Like Grow(m_capacity * 2) followed by the emplace, except that the new element is built
+    // before the old ones are moved: args may refer to an element of this very vector.
+    template <typename... Args>
+    T& GrowAndEmplaceBack(Args&&... args) {
+        const size_t newCapacity = m_capacity * 2;
+        if (TryGrowInPlace(newCapacity)) {
+            T* slot = new (m_data + m_size) T(std::forward<Args>(args)...);
+            ++m_size;
+            return *slot;
+        }
+
+        T* newData = AllocStorage(newCapacity);
+        T* slot = new (newData + m_size) T(std::forward<Args>(args)...);
+        try {
+            MoveInto(newData, newCapacity);
+        } catch (...) {
+            std::destroy_at(slot);
+            throw;
+        }
+        ++m_size;
+        return *slot;
+    }
+
+    // Fast path: if our buffer is the most recent arena allocation, just bump the top.
+    // This keeps a vector that is being filled in a loop at bump-pointer speed.
+    bool TryGrowInPlace(const size_t newCapacity) {
+        if (newCapacity > SIZE_MAX / sizeof(T)) throw std::bad_alloc();
+
+        if (!IsInline() &&
+            m_arena->TryExtend(m_data, m_capacity * sizeof(T), newCapacity * sizeof(T))) {
+            m_capacity = newCapacity;
+            return true;
+        }
+        return false;
+    }
+
+    T* AllocStorage(const size_t newCapacity) {
+        T* newData = m_arena->AllocArray<T>(newCapacity);
+        if (!newData) throw std::bad_alloc();
+        return newData;
+    }
+
+    void MoveInto(T* newData, const size_t newCapacity) {
+        // The old block (if spilled) is simply abandoned; the arena reclaims it on reset.
+        std::uninitialized_move_n(m_data, m_size, newData);
+        std::destroy_n(m_data, m_size);
+        m_data = newData;
+        m_capacity = newCapacity;
+    }
+
+    void StealFrom(ArenaSmallVector& other) {
+        if (other.IsInline()) {
+            // Inline elements have to be moved one by one.
+            std::uninitialized_move_n(other.m_data, other.m_size, m_data);
+            std::destroy_n(other.m_data, other.m_size);
+            m_size = other.m_size;
+        } else {
+            // Spilled storage lives in the arena, so ownership transfer is O(1).
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+        }
+
+        other.m_data = other.InlineData();
+        other.m_size = 0;
+        other.m_capacity = N;
+    }
+
+    ArenaAllocator* m_arena; // Spill target
+    alignas(T) std::byte m_inline[N * sizeof(T)]; // Inline element storage
+    T* m_data = InlineData(); // Points to m_inline or into the arena
+    size_t m_size = 0; // Constructed element count
+    size_t m_capacity = N; // Element slots available at m_data
+};
+#endif //ARENA_SMALL_VECTOR_H
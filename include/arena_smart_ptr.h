@@ -0,0 +1,184 @@
+#pragma once
+#ifndef ARENA_SMART_PTR_H
+#define ARENA_SMART_PTR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Owning pointer to an arena object: runs the destructor, never frees memory
+ *
+ * Use it for arena objects that hold resources (handles, nested containers) and must be
+ * destructed deterministically. The bytes themselves are reclaimed by Reset()/ResetToMarker().
+ * @warning Let every ArenaUnique go out of scope before resetting its arena.
+ */
+template <typename T>
+class ArenaUnique {
+public:
+    ArenaUnique() = default;
+    explicit ArenaUnique(T* ptr) : m_ptr(ptr) {}
+
+    ~ArenaUnique() {
+        Reset();
+    }
+
+    ArenaUnique(const ArenaUnique&) = delete;
+    ArenaUnique& operator=(const ArenaUnique&) = delete;
+
+    ArenaUnique(ArenaUnique&& other) noexcept : m_ptr(other.Release()) {}
+
+    /** @brief Converts from a derived type, like std::unique_ptr (needs a virtual destructor) */
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    ArenaUnique(ArenaUnique<U>&& other) noexcept : m_ptr(other.Release()) {}
+
+    ArenaUnique& operator=(ArenaUnique&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            m_ptr = other.Release();
+        }
+        return *this;
+    }
+
+    /** @brief Destroys the object (if any); its memory stays in the arena */
+    void Reset() {
+        if (m_ptr) {
+            std::destroy_at(m_ptr);
+            m_ptr = nullptr;
+        }
+    }
+
+    /** @brief Gives up ownership without destroying the object */
+    [[nodiscard]] T* Release() {
+        return std::exchange(m_ptr, nullptr);
+    }
+
+    [[nodiscard]] T* Get() const { return m_ptr; }
+    T& operator*() const { return *m_ptr; }
+    T* operator->() const { return m_ptr; }
+    explicit operator bool() const { return m_ptr != nullptr; }
+
+private:
+    T* m_ptr = nullptr;
+};
+
+namespace arena_smart_ptr_detail {
+
+// Header shared by every ArenaShared block; destroy knows the concrete object type.
+struct ControlBlock {
+    uint32_t refCount;
+    void (*destroy)(ControlBlock*);
+};
+
+template <typename T>
+struct Block : ControlBlock {
+    T value;
+
+    template <typename... Args>
+    explicit Block(Args&&... args)
+        : ControlBlock{1, &Block::Destroy}, value(std::forward<Args>(args)...) {}
+
+    static void Destroy(ControlBlock* block) {
+        std::destroy_at(&static_cast<Block*>(block)->value);
+    }
+};
+
+} // namespace arena_smart_ptr_detail
+
+/**
+ * @brief Reference-counted pointer whose count and object share one arena allocation
+ *
+ * Counting is non-atomic, matching the single-threaded contract of ArenaAllocator. When the
+ * last reference goes away the object's destructor runs, but nothing is freed: the block is
+ * reclaimed with the rest of the arena on Reset().
+ * @warning Let every ArenaShared go out of scope before resetting its arena.
+ */
+template <typename T>
+class ArenaShared {
+    using ControlBlock = arena_smart_ptr_detail::ControlBlock;
+
+public:
+    ArenaShared() = default;
+
+    ~ArenaShared() {
+        Release();
+    }
+
+    ArenaShared(const ArenaShared& other) : m_ptr(other.m_ptr), m_control(other.m_control) {
+        if (m_control) ++m_control->refCount;
+    }
+
+    ArenaShared(ArenaShared&& other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)),
+          m_control(std::exchange(other.m_control, nullptr)) {}
+
+    /** @brief Converts from a derived type, like std::shared_ptr */
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    ArenaShared(const ArenaShared<U>& other) : m_ptr(other.m_ptr), m_control(other.m_control) {
+        if (m_control) ++m_control->refCount;
+    }
+
+    ArenaShared& operator=(ArenaShared other) noexcept {
+        std::swap(m_ptr, other.m_ptr);
+        std::swap(m_control, other.m_control);
+        return *this;
+    }
+
+    /** @brief Drops this reference; destroys the object if it was the last one */
+    void Reset() {
+        Release();
+    }
+
+    [[nodiscard]] uint32_t UseCount() const { return m_control ? m_control->refCount : 0; }
+    [[nodiscard]] T* Get() const { return m_ptr; }
+    T& operator*() const { return *m_ptr; }
+    T* operator->() const { return m_ptr; }
+    explicit operator bool() const { return m_ptr != nullptr; }
+
+private:
+    template <typename>
+    friend class ArenaShared;
+
+    template <typename U, typename... Args>
+    friend ArenaShared<U> MakeArenaShared(ArenaAllocator& arena, Args&&... args);
+
+    ArenaShared(T* ptr, ControlBlock* control) : m_ptr(ptr), m_control(control) {}
+
+    void Release() {
+        if (m_control && --m_control->refCount == 0) {
+            m_control->destroy(m_control);
+        }
+        m_ptr = nullptr;
+        m_control = nullptr;
+    }
+
+    T* m_ptr = nullptr;
+    ControlBlock* m_control = nullptr;
+};
+
+/**
+ * @brief Constructs a T in the arena, owned by an ArenaUnique
+ * @return Empty pointer if the arena is out of space (like New<T>())
+ */
+template <typename T, typename... Args>
+[[nodiscard]] ArenaUnique<T> MakeArenaUnique(ArenaAllocator& arena, Args&&... args) {
+    return ArenaUnique<T>(arena.New<T>(std::forward<Args>(args)...));
+}
+
+/**
+ * @brief Constructs a T and its reference count in one arena allocation
+ * @return Empty pointer if the arena is out of space (like New<T>())
+ */
+template <typename T, typename... Args>
+[[nodiscard]] ArenaShared<T> MakeArenaShared(ArenaAllocator& arena, Args&&... args) {
+    using Block = arena_smart_ptr_detail::Block<T>;
+
+    Block* block = arena.New<Block>(std::forward<Args>(args)...);
+    if (!block) return {};
+    return ArenaShared<T>(&block->value, block);
+}
+#endif //ARENA_SMART_PTR_H
@@ -0,0 +1,192 @@
+#pragma once
+#ifndef ARENA_SPARSE_SET_H
+#define ARENA_SPARSE_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Sparse set mapping entity ids to packed components, with all storage in an arena
+ *
+ * The sparse side maps an entity id to its dense index through two levels of directories
+ * (like a page table) down to fixed-size pages. Directories and pages are allocated the first
+ * time an id in their range is inserted, so a few entities with large, scattered ids cost a
+ * few pages rather than an array sized by the largest id.
+ * The dense side keeps entities and components in two parallel packed arrays. Removal moves
+ * the last element into the hole, so iteration is a tight loop over Size() elements in no
+ * particular order.
+ *
+ * Insert, Remove and Find are O(1). Outgrown dense arrays are abandoned in the
+ * arena, like ArenaSmallVector's spilled buffers, and reclaimed on its reset.
+ * @warning The set must not outlive the arena region it allocated from. Pointers returned by
+ *          Find() or Components() are invalidated by Insert() and Remove().
+ */
+template <typename T>
+class ArenaSparseSet {
+public:
+    static constexpr uint32_t kPageShift = 12; // With two 10-bit directory levels: 32-bit ids
+    static constexpr uint32_t kPageSize = 1u << kPageShift; // Sparse entries per page
+    static constexpr uint32_t kAbsent = 0xFFFFFFFFu; // Sparse entry of an id not in the set
+    static constexpr uint32_t kDirectoryShift = 10; // Id bits per directory level
+    static constexpr uint32_t kDirectorySize = 1u << kDirectoryShift;
+
+    explicit ArenaSparseSet(ArenaAllocator& arena) : m_arena(&arena) {}
+
+    ~ArenaSparseSet() {
+        // Components are destroyed; pages and arrays stay in the arena until it is reset.
+        std::destroy_n(m_components, m_size);
+    }
+
+    ArenaSparseSet(const ArenaSparseSet&) = delete;
+    ArenaSparseSet& operator=(const ArenaSparseSet&) = delete;
+
+    /**
+     * @brief Constructs the component of entity at the end of the dense arrays
+     * @throws std::invalid_argument if entity already has a component
+     * @throws std::bad_alloc if the arena is out of space
+     */
+    template <typename... Args>
+    T& Insert(const uint32_t entity, Args&&... args) {
+        uint32_t* page = PageFor(entity);
+        uint32_t& slot = page[entity & (kPageSize - 1)];
+        if (slot != kAbsent) throw std::invalid_argument("ArenaSparseSet: entity already present");
+
+        T* component = m_size == m_capacity
+                           ? GrowAndConstruct(std::forward<Args>(args)...)
+                           : ::new (m_components + m_size) T(std::forward<Args>(args)...);
+        m_entities[m_size] = entity;
+        slot = static_cast<uint32_t>(m_size++);
+        return *component;
+    }
+
+    /** @return false if entity had no component */
+    bool Remove(const uint32_t entity) {
+        uint32_t* slot = SlotOf(entity);
+        if (!slot || *slot == kAbsent) return false;
+
+        const uint32_t index = *slot;
+        const size_t last = m_size - 1;
+        if (index != last) {
+            m_components[index] = std::move(m_components[last]);
+            m_entities[index] = m_entities[last];
+            *SlotOf(m_entities[index]) = index;
+        }
+        std::destroy_at(m_components + last);
+        *slot = kAbsent;
+        --m_size;
+        return true;
+    }
+
+    /** @return The component of entity, or nullptr */
+    [[nodiscard]] T* Find(const uint32_t entity) {
+        const uint32_t* slot = SlotOf(entity);
+        return slot && *slot != kAbsent ? m_components + *slot : nullptr;
+    }
+
+    [[nodiscard]] const T* Find(const uint32_t entity) const {
+        return const_cast<ArenaSparseSet*>(this)->Find(entity);
+    }
+
+    [[nodiscard]] bool Contains(const uint32_t entity) const { return Find(entity) != nullptr; }
+
+    /** @brief Calls func(entity, component) for every element, in dense order */
+    template <typename Func>
+    void ForEach(Func func) {
+        for (size_t i = 0; i < m_size; ++i) func(m_entities[i], m_components[i]);
+    }
+
+    /** @brief Destroys all components; pages and capacity are kept for reuse */
+    void Clear() {
+        for (size_t i = 0; i < m_size; ++i) *SlotOf(m_entities[i]) = kAbsent;
+        std::destroy_n(m_components, m_size);
+        m_size = 0;
+    }
+
+    /** @brief Packed entity ids, parallel to Components() */
+    [[nodiscard]] const uint32_t* Entities() const { return m_entities; }
+    [[nodiscard]] T* Components() { return m_components; }
+    [[nodiscard]] const T* Components() const { return m_components; }
+
+    [[nodiscard]] size_t Size() const { return m_size; }
+    [[nodiscard]] bool IsEmpty() const { return m_size == 0; }
+
+    /** @brief Sparse pages allocated so far, each kPageSize * 4 bytes */
+    [[nodiscard]] size_t GetPageCount() const { return m_allocatedPages; }
+
+private:
+    // Sparse entry of entity, or nullptr if its page was never allocated.
+    uint32_t* SlotOf(const uint32_t entity) const {
+        if (!m_root) return nullptr;
+        uint32_t** directory = m_root[entity >> (kPageShift + kDirectoryShift)];
+        if (!directory) return nullptr;
+        uint32_t* page = directory[(entity >> kPageShift) & (kDirectorySize - 1)];
+        return page ? page + (entity & (kPageSize - 1)) : nullptr;
+    }
+
+    uint32_t* PageFor(const uint32_t entity) {
+        if (!m_root) m_root = NewDirectory<uint32_t**>();
+        uint32_t**& directory = m_root[entity >> (kPageShift + kDirectoryShift)];
+        if (!directory) directory = NewDirectory<uint32_t*>();
+
+        uint32_t*& page = directory[(entity >> kPageShift) & (kDirectorySize - 1)];
+        if (!page) {
+            page = m_arena->AllocArray<uint32_t>(kPageSize);
+            if (!page) throw std::bad_alloc();
+            std::memset(page, 0xFF, kPageSize * sizeof(uint32_t)); // Every entry kAbsent
+            ++m_allocatedPages;
+        }
+        return page;
+    }
+
+    template <typename Entry>
+    Entry* NewDirectory() {
+        auto* directory = m_arena->AllocArray<Entry>(kDirectorySize);
+        if (!directory) throw std::bad_alloc();
+        std::fill_n(directory, kDirectorySize, nullptr);
+        return directory;
+    }
+
+    // Builds the new component in the grown arrays before the old ones are moved and
+    // destroyed, so args may refer to a component of this set (Insert(e, *Find(other))).
+    template <typename... Args>
+    T* GrowAndConstruct(Args&&... args) {
+        const size_t newCapacity = m_capacity ? m_capacity * 2 : 16;
+
+        // Both arrays are reallocated together; the old ones are abandoned to the arena.
+        auto* entities = m_arena->AllocArray<uint32_t>(newCapacity);
+        T* components = m_arena->AllocArray<T>(newCapacity);
+        if (!entities || !components) throw std::bad_alloc();
+
+        T* component = ::new (components + m_size) T(std::forward<Args>(args)...);
+        try {
+            std::uninitialized_move_n(m_components, m_size, components);
+        } catch (...) {
+            std::destroy_at(component);
+            throw;
+        }
+
+        if (m_size) std::memcpy(entities, m_entities, m_size * sizeof(uint32_t));
+        std::destroy_n(m_components, m_size);
+        m_entities = entities;
+        m_components = components;
+        m_capacity = newCapacity;
+        return component;
+    }
+
+    ArenaAllocator* m_arena; // Source of pages, directories and dense arrays
+    uint32_t*** m_root = nullptr; // Top 10 id bits -> directory; middle 10 bits -> page
+    size_t m_allocatedPages = 0;
+    uint32_t* m_entities = nullptr; // Dense entity ids
+    T* m_components = nullptr; // Dense components, parallel to m_entities
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+};
+#endif //ARENA_SPARSE_SET_H
@@ -0,0 +1,169 @@
+#pragma once
+#ifndef ARENA_SPATIAL_GRID_H
+#define ARENA_SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+#include "arena_allocator.h"
+
+/**
+ * @brief Uniform grid hashed into a fixed bucket table, rebuilt each frame by counting sort
+ *
+ * Build() sorts entity ids (and a copy of their positions) by bucket, so every bucket is one
+ * contiguous range: no per-cell vectors and nothing to clear between frames. All arrays come
+ * from the arena passed to Build(); resetting that arena is the whole teardown.
+ *
+ * Distinct cells can share a bucket. Queries check each entity's real cell, so collisions cost
+ * a little extra scanning but never produce wrong or duplicate results.
+ */
+class SpatialHashGrid {
+public:
+    /**
+     * @param cellSize Edge length of a cell; about the typical query radius works best
+     * @param bucketCount Hash table size, rounded up to a power of two
+     * @throws std::invalid_argument if bucketCount is above 2^31 (no uint32_t power of two fits)
+     */
+    SpatialHashGrid(const float cellSize, const uint32_t bucketCount)
+        : m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize) {
+        if (bucketCount > kMaxBucketCount) {
+            throw std::invalid_argument("SpatialHashGrid: bucket count above 2^31");
+        }
+        uint32_t buckets = 1;
+        while (buckets < bucketCount) buckets <<= 1;
+        m_bucketMask = buckets - 1;
+    }
+
+    /**
+     * @brief Rebuilds the grid from points (any type with float x, y, z members)
+     * @throws std::bad_alloc if the arena is out of space
+     */
+    template <typename Point>
+    void Build(ArenaAllocator& arena, const Point* points, const uint32_t count) {
+        const uint32_t bucketCount = m_bucketMask + 1;
+
+        m_bucketStart = arena.AllocArray<uint32_t>(static_cast<size_t>(bucketCount) + 1);
+        m_entities = arena.AllocArray<uint32_t>(count);
+        m_positions = arena.AllocArray<Position>(count);
+        if (!m_bucketStart || !m_entities || !m_positions) throw std::bad_alloc();
+        m_count = count;
+
+        ArenaScope scratch(arena);
+        auto* bucketOf = arena.AllocArray<uint32_t>(count);
+        if (!bucketOf && count > 0) throw std::bad_alloc();
+
+        // Counting sort: histogram, exclusive prefix sum, then scatter.
+        std::fill_n(m_bucketStart, bucketCount + 1, 0u);
+        for (uint32_t i = 0; i < count; ++i) {
+            bucketOf[i] = BucketOf(CellOf(points[i].x), CellOf(points[i].y), CellOf(points[i].z));
+            ++m_bucketStart[bucketOf[i] + 1];
+        }
+        for (uint32_t b = 0; b < bucketCount; ++b) m_bucketStart[b + 1] += m_bucketStart[b];
+
+        // m_bucketStart[b] serves as bucket b's write cursor and is shifted back afterwards.
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t slot = m_bucketStart[bucketOf[i]]++;
+            m_entities[slot] = i;
+            m_positions[slot] = Position{points[i].x, points[i].y, points[i].z};
+        }
+        for (uint32_t b = bucketCount; b > 0; --b) m_bucketStart[b] = m_bucketStart[b - 1];
+        m_bucketStart[0] = 0;
+    }
+
+    /** @brief Calls func(entityId) for every entity in the cell containing (x, y, z) */
+    template <typename Func>
+    void ForEachInCell(const float x, const float y, const float z, Func func) const {
+        VisitCell(CellOf(x), CellOf(y), CellOf(z), [&](const uint32_t slot) {
+            func(m_entities[slot]);
+        });
+    }
+
+    /**
+     * @brief Calls func(entityId, distanceSquared) for every entity within radius of the center
+     * @note Each entity is reported exactly once, even when cells collide in the hash table.
+     */
+    template <typename Func>
+    void ForEachInRadius(const float x, const float y, const float z, const float radius,
+                         Func func) const {
+        const float radiusSquared = radius * radius;
+        const int32_t minX = CellOf(x - radius), maxX = CellOf(x + radius);
+        const int32_t minY = CellOf(y - radius), maxY = CellOf(y + radius);
+        const int32_t minZ = CellOf(z - radius), maxZ = CellOf(z + radius);
+
+        for (int32_t cz = minZ; cz <= maxZ; ++cz) {
+            for (int32_t cy = minY; cy <= maxY; ++cy) {
+                for (int32_t cx = minX; cx <= maxX; ++cx) {
+                    VisitCell(cx, cy, cz, [&](const uint32_t slot) {
+                        const Position& p = m_positions[slot];
+                        const float dx = p.x - x, dy = p.y - y, dz = p.z - z;
+                        const float distanceSquared = dx * dx + dy * dy + dz * dz;
+                        if (distanceSquared <= radiusSquared) func(m_entities[slot], distanceSquared);
+                    });
+                }
+            }
+        }
+    }
+
+    /** @brief Forgets the last build; call alongside the arena's Reset() */
+    void Clear() {
+        m_bucketStart = nullptr;
+        m_entities = nullptr;
+        m_positions = nullptr;
+        m_count = 0;
+    }
+
+    [[nodiscard]] uint32_t GetEntityCount() const { return m_count; }
+    [[nodiscard]] uint32_t GetBucketCount() const { return m_bucketMask + 1; }
+    [[nodiscard]] float GetCellSize() const { return m_cellSize; }
+
+private:
+    static constexpr uint32_t kMaxBucketCount = uint32_t{1} << 31;
+    static constexpr int32_t kMaxCell = int32_t{1} << 30;
+
+    struct Position {
+        float x, y, z;
+    };
+
+    // Coordinates beyond kMaxCell cells (and NaN, which goes to the low end) share the edge
+    // cell. Clamping in float keeps the conversion defined, and the margin to INT32_MAX keeps
+    // ForEachInRadius's ++cx from overflowing.
+    [[nodiscard]] int32_t CellOf(const float coordinate) const {
+        const float cell = std::floor(coordinate * m_inverseCellSize);
+        if (cell >= static_cast<float>(kMaxCell)) return kMaxCell;
+        if (!(cell > static_cast<float>(-kMaxCell))) return -kMaxCell;
+        return static_cast<int32_t>(cell);
+    }
+
+    // Spatial hash from Teschner et al., "Optimized Spatial Hashing for Collision Detection".
+    [[nodiscard]] uint32_t BucketOf(const int32_t cx, const int32_t cy, const int32_t cz) const {
+        const uint32_t hash = (static_cast<uint32_t>(cx) * 73856093u) ^
+                              (static_cast<uint32_t>(cy) * 19349663u) ^
+                              (static_cast<uint32_t>(cz) * 83492791u);
+        return hash & m_bucketMask;
+    }
+
+    // Visits the sorted slots of entities that really live in cell (cx, cy, cz).
+    template <typename Func>
+    void VisitCell(const int32_t cx, const int32_t cy, const int32_t cz, Func func) const {
+        if (m_count == 0) return;
+
+        const uint32_t bucket = BucketOf(cx, cy, cz);
+        for (uint32_t slot = m_bucketStart[bucket]; slot < m_bucketStart[bucket + 1]; ++slot) {
+            const Position& p = m_positions[slot];
+            if (CellOf(p.x) == cx && CellOf(p.y) == cy && CellOf(p.z) == cz) func(slot);
+        }
+    }
+
+    float m_cellSize;
+    float m_inverseCellSize;
+    uint32_t m_bucketMask; // bucketCount - 1
+    uint32_t* m_bucketStart = nullptr; // bucketCount + 1 offsets into the sorted arrays
+    uint32_t* m_entities = nullptr; // Entity ids sorted by bucket
+    Position* m_positions = nullptr; // Positions in the same order, for cache-friendly queries
+    uint32_t m_count = 0;
+};
+#endif //ARENA_SPATIAL_GRID_H
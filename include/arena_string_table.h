@@ -0,0 +1,319 @@
+#pragma once
+#ifndef ARENA_STRING_TABLE_H
+#define ARENA_STRING_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ARENA_STRING_TABLE_SSE2 1
+#endif
+
+#include "arena_allocator.h"
+#include "arena_parallel.h"
+
+namespace arena_string_table_detail {
+
+/** @brief Index of the first differing byte of a and b within length, or length if none */
+inline size_t MismatchIndex(const char* a, const char* b, const size_t length) {
+    size_t i = 0;
+#ifdef ARENA_STRING_TABLE_SSE2
+    // 16 bytes per compare; the movemask has a 0 bit at every differing byte.
+    for (; i + 16 <= length; i += 16) {
+        const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const auto equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)));
+        if (equal != 0xFFFF) return i + __builtin_ctz(~equal);
+    }
+#endif
+    for (; i < length; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return length;
+}
+
+/** @brief Lexicographic three-way compare by unsigned bytes, like std::string */
+inline int Compare(const std::string_view a, const std::string_view b) {
+    const size_t common = std::min(a.size(), b.size());
+    const size_t mismatch = MismatchIndex(a.data(), b.data(), common);
+    if (mismatch < common) {
+        return static_cast<unsigned char>(a[mismatch]) < static_cast<unsigned char>(b[mismatch])
+                   ? -1
+                   : 1;
+    }
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+} // namespace arena_string_table_detail
+
+/**
+ * @brief Arrow-style string column: one offsets array and one contiguous byte buffer
+ *
+ * String i is bytes[offsets[i], offsets[i + 1]). Both arrays are 64-byte aligned arena
+ * allocations that double when full (outgrown arrays are abandoned to the arena), so
+ * Reserve() the expected totals to build a batch with two allocations. Equality and prefix
+ * checks compare 16 bytes at a time; Sort() is a stable MSD radix sort that can split its
+ * top-level buckets across threads.
+ * @warning Must not outlive the arena region it allocated from. The total byte size is
+ *          limited to 4 GiB (32-bit offsets).
+ */
+class ArenaStringTable {
+public:
+    explicit ArenaStringTable(ArenaAllocator& arena) : m_arena(&arena) {}
+
+    /** @throws std::bad_alloc if the arena cannot provide the requested capacity */
+    void Reserve(const size_t stringCount, const size_t byteCount) {
+        if (stringCount + 1 > m_offsetCapacity) GrowOffsets(stringCount + 1);
+        if (byteCount > m_byteCapacity) GrowBytes(byteCount);
+    }
+
+    /**
+     * @brief Copies text to the end of the table
+     * @return Index of the new string
+     * @throws std::bad_alloc if the arena is out of space or the table would pass 4 GiB
+     */
+    uint32_t Append(const std::string_view text) {
+        const size_t byteSize = GetByteSize();
+        if (byteSize + text.size() > UINT32_MAX) throw std::bad_alloc();
+        if (m_count + 2 > m_offsetCapacity) {
+            GrowOffsets(std::max<size_t>(m_offsetCapacity * 2, 64));
+        }
+        if (byteSize + text.size() > m_byteCapacity) {
+            GrowBytes(std::max(m_byteCapacity * 2, byteSize + text.size()));
+        }
+
+        if (!text.empty()) std::memcpy(m_bytes + byteSize, text.data(), text.size());
+        m_offsets[m_count + 1] = static_cast<uint32_t>(byteSize + text.size());
+        return static_cast<uint32_t>(m_count++);
+    }
+
+    [[nodiscard]] std::string_view Get(const size_t index) const {
+        return {m_bytes + m_offsets[index], m_offsets[index + 1] - m_offsets[index]};
+    }
+
+    [[nodiscard]] bool Equals(const size_t index, const std::string_view text) const {
+        const std::string_view value = Get(index);
+        return value.size() == text.size() &&
+               arena_string_table_detail::MismatchIndex(value.data(), text.data(), text.size()) ==
+                   text.size();
+    }
+
+    [[nodiscard]] bool Equals(const size_t a, const size_t b) const { return Equals(a, Get(b)); }
+
+    [[nodiscard]] bool StartsWith(const size_t index, const std::string_view prefix) const {
+        const std::string_view value = Get(index);
+        return value.size() >= prefix.size() &&
+               arena_string_table_detail::MismatchIndex(value.data(), prefix.data(),
+                                                        prefix.size()) == prefix.size();
+    }
+
+    /** @brief Three-way lexicographic compare of strings a and b (bytes compared as unsigned) */
+    [[nodiscard]] int Compare(const size_t a, const size_t b) const {
+        return arena_string_table_detail::Compare(Get(a), Get(b));
+    }
+
+    /**
+     * @brief Writes the indices of all strings to order, sorted lexicographically and stably
+     * @param order Size() entries
+     * @param scratch Holds temporary index and bucket arrays and the worker threads; rewound
+     *                on return
+     * @param threadCount Workers sharing the top-level buckets (1 = calling thread only)
+     * @throws std::bad_alloc if scratch is out of space
+     * @throws std::system_error if a worker thread cannot be started
+     */
+    void Sort(uint32_t* order, ArenaAllocator& scratch, unsigned threadCount = 1) const {
+        for (uint32_t i = 0; i < m_count; ++i) order[i] = i;
+        if (m_count < 2) return;
+
+        ArenaScope scope(scratch);
+        auto* temp = scratch.AllocArray<uint32_t>(m_count);
+        auto* buckets = scratch.AllocArray<uint16_t>(m_count);
+        if (!temp || !buckets) throw std::bad_alloc();
+
+        if (threadCount <= 1 || m_count < kParallelThreshold) {
+            SortRange(order, temp, buckets, m_count, 0, 0);
+            return;
+        }
+
+        // Split once on the first byte here, then let threads claim whole buckets.
+        uint32_t bucketStart[kBucketCount + 1];
+        Partition(order, temp, buckets, m_count, 0, bucketStart);
+        std::atomic<uint32_t> nextBucket{1}; // Bucket 0 holds empty strings: already in order
+
+        arena_parallel_detail::ParallelFor(scratch, threadCount, [&](unsigned) {
+            for (uint32_t bucket = nextBucket.fetch_add(1); bucket < kBucketCount;
+                 bucket = nextBucket.fetch_add(1)) {
+                const uint32_t begin = bucketStart[bucket];
+                SortRange(order + begin, temp + begin, buckets + begin,
+                          bucketStart[bucket + 1] - begin, 1, 0);
+            }
+        });
+    }
+
+    /** @brief Drops all strings, keeping the capacity */
+    void Clear() { m_count = 0; }
+
+    [[nodiscard]] size_t Size() const { return m_count; }
+    [[nodiscard]] bool IsEmpty() const { return m_count == 0; }
+    [[nodiscard]] size_t GetByteSize() const { return m_offsets ? m_offsets[m_count] : 0; }
+
+    /** @brief Size() + 1 entries (null while empty and unreserved) */
+    [[nodiscard]] const uint32_t* Offsets() const { return m_offsets; }
+    [[nodiscard]] const char* Bytes() const { return m_bytes; }
+
+private:
+    static constexpr uint32_t kBucketCount = 257; // End of string, then one per byte value
+    static constexpr uint32_t kInsertionSortThreshold = 32;
+    static constexpr uint32_t kMaxRadixDepth = 64; // Deeper splits fall back to comparisons
+    static constexpr uint32_t kParallelThreshold = 4096;
+
+    // Bucket of string index at depth: 0 once the string has ended, else 1 + the byte.
+    [[nodiscard]] uint32_t BucketOf(const uint32_t index, const size_t depth) const {
+        const uint32_t begin = m_offsets[index];
+        if (depth >= m_offsets[index + 1] - begin) return 0;
+        return 1u + static_cast<unsigned char>(m_bytes[begin + depth]);
+    }
+
+    /**
+     * @brief Stable counting sort of order[0, count) by the byte at depth, through temp
+     * @param buckets Caches each string's bucket, so the scatter pass does not read the
+     *                string bytes a second time
+     * @return false, leaving order untouched, if every string fell into the same bucket
+     */
+    bool Partition(uint32_t* order, uint32_t* temp, uint16_t* buckets, const uint32_t count,
+                   const size_t depth, uint32_t (&bucketStart)[kBucketCount + 1]) const {
+        std::fill_n(bucketStart, kBucketCount + 1, 0u);
+        for (uint32_t i = 0; i < count; ++i) {
+            buckets[i] = static_cast<uint16_t>(BucketOf(order[i], depth));
+            ++bucketStart[buckets[i] + 1];
+        }
+        if (bucketStart[buckets[0] + 1] == count) {
+            for (uint32_t b = 0; b < kBucketCount; ++b) bucketStart[b + 1] += bucketStart[b];
+            return false;
+        }
+        for (uint32_t b = 0; b < kBucketCount; ++b) bucketStart[b + 1] += bucketStart[b];
+
+        uint32_t cursor[kBucketCount];
+        std::copy_n(bucketStart, kBucketCount, cursor);
+        for (uint32_t i = 0; i < count; ++i) temp[cursor[buckets[i]]++] = order[i];
+        std::copy_n(temp, count, order);
+        return true;
+    }
+
+    void SortRange(uint32_t* order, uint32_t* temp, uint16_t* buckets, const uint32_t count,
+                   size_t depth, const uint32_t recursion) const {
+        while (count > kInsertionSortThreshold && recursion < kMaxRadixDepth) {
+            uint32_t bucketStart[kBucketCount + 1];
+            if (!Partition(order, temp, buckets, count, depth, bucketStart)) {
+                if (bucketStart[1] == count) return; // Every string ended: all equal
+                // All strings share this byte: skip their whole common prefix without recursing.
+                depth += SharedPrefixLength(order, count, depth);
+                continue;
+            }
+
+            // Bucket 0 holds the strings that ended here; they are equal and already in order.
+            for (uint32_t b = 1; b < kBucketCount; ++b) {
+                const uint32_t begin = bucketStart[b];
+                const uint32_t size = bucketStart[b + 1] - begin;
+                if (size > 1) {
+                    SortRange(order + begin, temp + begin, buckets + begin, size, depth + 1,
+                              recursion + 1);
+                }
+            }
+            return;
+        }
+
+        // Small ranges, or long shared prefixes that would recurse too deep: compare the rest.
+        const auto less = [&](const uint32_t a, const uint32_t b) {
+            const std::string_view left = Get(a);
+            const std::string_view right = Get(b);
+            return arena_string_table_detail::Compare(left.substr(std::min(depth, left.size())),
+                                                      right.substr(std::min(depth, right.size()))) <
+                   0;
+        };
+        MergeSort(order, temp, count, less);
+    }
+
+    // Bytes from depth on that all strings in order[0, count) share; at least 1 when called.
+    [[nodiscard]] size_t SharedPrefixLength(const uint32_t* order, const uint32_t count,
+                                            const size_t depth) const {
+        const std::string_view first = Get(order[0]).substr(depth);
+        size_t shared = first.size();
+        for (uint32_t i = 1; i < count && shared > 1; ++i) {
+            const std::string_view other = Get(order[i]).substr(depth);
+            shared = arena_string_table_detail::MismatchIndex(first.data(), other.data(),
+                                                              std::min(shared, other.size()));
+        }
+        return shared;
+    }
+
+    // Stable bottom-up merge sort through temp: insertion-sorted runs, then merge passes.
+    template <typename Less>
+    static void MergeSort(uint32_t* order, uint32_t* temp, const uint32_t count, Less less) {
+        for (uint32_t runStart = 0; runStart < count; runStart += kInsertionSortThreshold) {
+            const uint32_t runEnd = std::min(runStart + kInsertionSortThreshold, count);
+            for (uint32_t i = runStart + 1; i < runEnd; ++i) {
+                const uint32_t value = order[i];
+                uint32_t j = i;
+                for (; j > runStart && less(value, order[j - 1]); --j) order[j] = order[j - 1];
+                order[j] = value;
+            }
+        }
+
+        uint32_t* from = order;
+        uint32_t* to = temp;
+        for (uint32_t width = kInsertionSortThreshold; width < count; width *= 2) {
+            for (uint32_t left = 0; left < count; left += 2 * width) {
+                const uint32_t middle = std::min(left + width, count);
+                const uint32_t right = std::min(left + 2 * width, count);
+                uint32_t i = left;
+                uint32_t j = middle;
+                uint32_t out = left;
+                while (i < middle && j < right) {
+                    to[out++] = less(from[j], from[i]) ? from[j++] : from[i++];
+                }
+                while (i < middle) to[out++] = from[i++];
+                while (j < right) to[out++] = from[j++];
+            }
+            std::swap(from, to);
+        }
+        if (from != order) std::copy_n(from, count, order);
+    }
+
+    void GrowOffsets(const size_t capacity) {
+        auto* offsets = static_cast<uint32_t*>(m_arena->Alloc(capacity * sizeof(uint32_t), 64));
+        if (!offsets) throw std::bad_alloc();
+        if (m_offsets) std::copy_n(m_offsets, m_count + 1, offsets);
+        else offsets[0] = 0;
+        m_offsets = offsets;
+        m_offsetCapacity = capacity;
+    }
+
+    void GrowBytes(const size_t capacity) {
+        // Fast path: the byte buffer is often the latest allocation, so it can grow in place.
+        if (m_bytes && m_arena->TryExtend(m_bytes, m_byteCapacity, capacity)) {
+            m_byteCapacity = capacity;
+            return;
+        }
+
+        auto* bytes = static_cast<char*>(m_arena->Alloc(capacity, 64));
+        if (!bytes) throw std::bad_alloc();
+        if (m_bytes) std::memcpy(bytes, m_bytes, GetByteSize());
+        m_bytes = bytes;
+        m_byteCapacity = capacity;
+    }
+
+    ArenaAllocator* m_arena; // Holds both arrays
+    uint32_t* m_offsets = nullptr; // m_count + 1 valid entries once allocated
+    char* m_bytes = nullptr;
+    size_t m_count = 0;
+    size_t m_offsetCapacity = 0;
+    size_t m_byteCapacity = 0;
+};
+#endif //ARENA_STRING_TABLE_H
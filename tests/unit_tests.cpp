@@ -1,6 +1,46 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "arena_allocator.h"
+#include "arena_deque.h"
+#include "arena_priority_queue.h"
+#include "arena_radix_tree.h"
+#include "arena_perfect_hash.h"
+#include "arena_csr_graph.h"
+#include "arena_bvh.h"
+#include "arena_spatial_grid.h"
+#include "arena_format.h"
+#include "arena_log.h"
+#include "arena_smart_ptr.h"
+#include "arena_function.h"
+#include "arena_profiler.h"
+#include "arena_registry.h"
+#include "arena_occupancy.h"
+#include "arena_memory_resource.h"
+#include "arena_filter.h"
+#include "arena_sparse_set.h"
+#include "arena_string_table.h"
+#include "arena_record_batch.h"
+#include "arena_hash_kernels.h"
+#include "arena_external_sort.h"
+#include "arena_memo_cache.h"
+#include "arena_parallel.h"
+#include "arena_small_vector.h"
 
 #define TEST_ASSERT(cond,msg) \
     if (!(cond)) { \
@@ -83,6 +123,1466 @@ void TestNoDestructorCallOnReset() {
     TEST_ASSERT(isDestructed == false, "Arena reset should NOT call destructors automatically");
 }
 
+void TestTryExtend() {
+    ArenaAllocator arena(1024);
+
+    void* block = arena.Alloc(64);
+    TEST_ASSERT(arena.TryExtend(block, 64, 128), "Top allocation should grow in place");
+    TEST_ASSERT(arena.GetUsedMemory() == 128, "Offset should follow the extended allocation");
+
+    void* other = arena.Alloc(16);
+    TEST_ASSERT(!arena.TryExtend(block, 128, 256), "Non-top allocation must not grow");
+    TEST_ASSERT(!arena.TryExtend(other, 16, 4096), "Growth past capacity must fail");
+}
+
+void TestSmallVectorInline() {
+    ArenaAllocator arena(1024);
+    ArenaSmallVector<int, 4> vec(arena);
+
+    for (int i = 0; i < 4; ++i) {
+        vec.PushBack(i);
+    }
+
+    TEST_ASSERT(vec.IsInline(), "Small vector should stay inline up to N elements");
+    TEST_ASSERT(arena.GetUsedMemory() == 0, "Inline elements should not touch the arena");
+}
+
+void TestSmallVectorSpill() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaSmallVector<int, 4> vec(arena);
+
+    for (int i = 0; i < 1000; ++i) {
+        vec.PushBack(i);
+    }
+
+    TEST_ASSERT(!vec.IsInline(), "Small vector should spill into the arena past N elements");
+    TEST_ASSERT(vec.Size() == 1000 && vec[999] == 999, "Spilled elements must be preserved");
+
+    // Every growth after the first spill should have been an in-place extension.
+    TEST_ASSERT(arena.GetUsedMemory() == vec.Capacity() * sizeof(int),
+                "Growth at the top of the arena should not copy into a new block");
+
+    ArenaSmallVector<int, 4> moved(std::move(vec));
+    TEST_ASSERT(moved.Size() == 1000 && vec.IsEmpty(), "Move should transfer spilled storage");
+    static_assert(std::is_nothrow_move_constructible_v<ArenaSmallVector<int, 4>>,
+                  "Moving a small vector of nothrow-movable elements should be noexcept");
+
+    bool threw = false;
+    try {
+        moved.Reserve(SIZE_MAX / sizeof(int) + 1);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw && moved.Size() == 1000, "A capacity overflowing size_t should be rejected");
+}
+
+void TestSmallVectorPushBackOwnElement() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaSmallVector<std::string, 2> vec(arena);
+    vec.PushBack(std::string(40, 'a')); // Long enough to live on the heap, not in the SSO buffer
+    vec.PushBack(std::string(40, 'b'));
+
+    // Test Case: the argument aliases an element that the spill is about to move.
+    vec.PushBack(vec[0]);
+    TEST_ASSERT(!vec.IsInline() && vec[2] == std::string(40, 'a'),
+                "Pushing a copy of an element while spilling should copy the original value");
+
+    // Test Case: the same while moving between two arena blocks (not at the top, so no extend).
+    vec.PushBack(vec[1]);
+    (void)arena.Alloc(16);
+    vec.PushBack(vec[3]);
+    TEST_ASSERT(vec.Size() == 5 && vec[4] == std::string(40, 'b') && vec[0] == vec[2],
+                "Pushing a copy of an element while relocating should copy the original value");
+}
+
+void TestDequeFifoOrder() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaDeque<int, 8> queue(arena);
+
+    // Test Case: A queue spanning many segments must keep FIFO order across segment hops.
+    for (int i = 0; i < 100; ++i) {
+        queue.PushBack(i);
+    }
+    queue.PushFront(-1);
+
+    TEST_ASSERT(queue.Size() == 101 && queue.Front() == -1 && queue.Back() == 99,
+                "Deque should grow at both ends");
+
+    int expected = -1;
+    bool ordered = true;
+    for (int value : queue) {
+        ordered = ordered && value == expected++;
+    }
+    TEST_ASSERT(ordered, "Iteration should visit elements front to back");
+
+    queue.PopFront();
+    queue.PopBack();
+    TEST_ASSERT(queue.Front() == 0 && queue.Back() == 98, "Pops should remove from both ends");
+}
+
+void TestDequeSegmentRecycling() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaDeque<int, 8> queue(arena);
+
+    // Test Case: Drained segments must be reused instead of taking fresh arena memory.
+    for (int i = 0; i < 64; ++i) {
+        queue.PushBack(i);
+    }
+
+    // A sliding window needs at most one segment more than it holds.
+    queue.PopFront();
+    queue.PushBack(64);
+    const size_t usedAfterFill = arena.GetUsedMemory();
+
+    for (int i = 0; i < 1000; ++i) {
+        queue.PopFront();
+        queue.PushBack(i);
+    }
+
+    TEST_ASSERT(arena.GetUsedMemory() == usedAfterFill, "Sliding window should not grow the arena");
+
+    queue.Clear();
+    TEST_ASSERT(queue.IsEmpty() && queue.GetFreeSegmentCount() > 0,
+                "Clear should return segments to the free list");
+}
+
+struct ThrowingValue {
+    ThrowingValue(const int v, const bool fail) : value(v) {
+        if (fail) throw std::runtime_error("ThrowingValue");
+    }
+    int value;
+};
+
+void TestDequeThrowingConstructor() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaDeque<ThrowingValue, 4> queue(arena);
+
+    const auto emplaceThrows = [&](const bool back) {
+        try {
+            if (back) queue.EmplaceBack(-1, true);
+            else queue.EmplaceFront(-1, true);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    // Test Case: a failed first element must not leave an empty segment attached.
+    TEST_ASSERT(emplaceThrows(true) && queue.IsEmpty(), "Failed emplace should leave it empty");
+
+    for (int i = 0; i < 4; ++i) queue.EmplaceBack(i, false); // Exactly one full segment
+
+    // Test Case: both ends are at a segment edge, so each emplace needs a fresh segment.
+    TEST_ASSERT(emplaceThrows(true) && emplaceThrows(false),
+                "Constructor exceptions should propagate");
+    int count = 0;
+    for (const ThrowingValue& element : queue) count += element.value == count ? 1 : 0;
+    TEST_ASSERT(queue.Size() == 4 && count == 4 && queue.Front().value == 0 &&
+                    queue.Back().value == 3,
+                "A throwing constructor should leave the deque unchanged");
+
+    queue.PopBack();
+    queue.EmplaceFront(-1, false);
+    TEST_ASSERT(queue.Front().value == -1 && queue.Back().value == 2,
+                "The deque should stay usable after a failed emplace");
+}
+
+void TestArenaScopeRewinds() {
+    ArenaAllocator arena(1024);
+    void* before = arena.Alloc(16);
+    const size_t used = arena.GetUsedMemory();
+
+    {
+        ArenaScope scope(arena);
+        void* temp = arena.Alloc(256);
+        TEST_ASSERT(temp != nullptr && arena.GetUsedMemory() > used, "Scope should allow allocation");
+    }
+
+    TEST_ASSERT(before != nullptr && arena.GetUsedMemory() == used,
+                "ArenaScope should rewind to its marker on destruction");
+}
+
+void TestIndexedHeapDecreaseKey() {
+    ArenaAllocator arena(4096);
+    ArenaIndexedHeap<int> heap(arena, 16);
+
+    const int priorities[] = {50, 20, 70, 10, 90, 30};
+    for (uint32_t id = 0; id < 6; ++id) {
+        heap.Push(id, priorities[id]);
+    }
+
+    // Test Case: Decrease-key must reorder in place instead of queueing a duplicate.
+    heap.DecreaseKey(4, 5);
+    TEST_ASSERT(heap.Size() == 6 && heap.Top() == 4, "Decreased id should move to the top");
+    TEST_ASSERT(!heap.PushOrDecrease(4, 8), "A worse priority must not replace a better one");
+
+    int previous = -1;
+    bool sorted = true;
+    while (!heap.IsEmpty()) {
+        const int priority = heap.TopPriority();
+        const uint32_t id = heap.Pop();
+        sorted = sorted && priority >= previous && !heap.Contains(id);
+        previous = priority;
+    }
+    TEST_ASSERT(sorted, "Pop should yield ids in ascending priority order");
+}
+
+void TestPathQueryDijkstra() {
+    ArenaAllocator arena(4096);
+    const size_t used = arena.GetUsedMemory();
+
+    // 0 -1-> 1 -1-> 2, plus a direct but expensive 0 -5-> 2 edge.
+    struct Edge { uint32_t from, to, cost; };
+    const Edge edges[] = {{0, 1, 1}, {1, 2, 1}, {0, 2, 5}};
+
+    {
+        ArenaPathQuery<uint32_t> query(arena, 3);
+        query.Relax(0, ArenaPathQuery<uint32_t>::kNoParent, 0);
+
+        while (!query.Open().IsEmpty()) {
+            const uint32_t node = query.Open().Pop();
+            for (const Edge& edge : edges) {
+                if (edge.from == node) {
+                    query.Relax(edge.to, node, query.Record(node).cost + edge.cost);
+                }
+            }
+        }
+
+        TEST_ASSERT(query.Record(2).cost == 2, "Dijkstra should find the cheaper two-hop path");
+
+        uint32_t hops = 0;
+        query.ForEachPathNode(2, [&](uint32_t) { ++hops; });
+        TEST_ASSERT(hops == 3, "Came-from chain should lead back to the start");
+    }
+
+    TEST_ASSERT(arena.GetUsedMemory() == used, "Query teardown should release its arena region");
+}
+
+void TestRadixTreeStringKeys() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaRadixTree<int> routes(arena);
+
+    // Test Case: Keys that are prefixes of each other and share compressed paths.
+    const char* paths[] = {"/api", "/api/users", "/api/users/42", "/api/orders", "/static/app.js"};
+    for (int i = 0; i < 5; ++i) {
+        routes.Insert(paths[i], i);
+    }
+
+    TEST_ASSERT(routes.Size() == 5 && !routes.Insert("/api", 99), "Duplicate insert should be rejected");
+    TEST_ASSERT(*routes.Find("/api") == 0 && *routes.Find("/api/users/42") == 2,
+                "Find should resolve prefix keys and deep keys");
+    TEST_ASSERT(routes.Find("/api/user") == nullptr && routes.Find("/ap") == nullptr,
+                "Partial keys inside a compressed path must not match");
+
+    const int* route = routes.FindLongestPrefix("/api/users/7/profile");
+    TEST_ASSERT(route && *route == 1, "Longest prefix match should pick the deepest stored prefix");
+
+    std::string visited;
+    routes.ForEachWithPrefix("/api/", [&](std::string_view key, int) {
+        visited += std::string(key) + ";";
+    });
+    TEST_ASSERT(visited == "/api/orders;/api/users;/api/users/42;",
+                "Prefix scan should visit matching keys in sorted order");
+
+    // Test Case: A const tree only hands out const values; a mutable one allows updates.
+    *routes.Find("/api/orders") = 30;
+    const ArenaRadixTree<int>& view = routes;
+    const int* found = view.Find("/api/orders");
+    static_assert(std::is_same_v<decltype(view.Find("/api")), const int*> &&
+                      std::is_same_v<decltype(view.FindLongestPrefix("/api")), const int*>,
+                  "Lookups on a const tree must return const values");
+    int sum = 0;
+    view.ForEachWithPrefix("/api/users", [&](std::string_view, const int& value) { sum += value; });
+    TEST_ASSERT(found && *found == 30 && sum == 3, "Const lookups should see the stored values");
+}
+
+void TestRadixTreeNodeGrowth() {
+    ArenaAllocator arena(1024 * 1024);
+    ArenaRadixTree<uint32_t> index(arena);
+
+    // Test Case: 1000 dense integers force the last-byte nodes through Node4/16/48/256.
+    for (uint32_t i = 0; i < 1000; ++i) {
+        index.Insert(static_cast<uint64_t>(i) * 7, i);
+    }
+
+    bool allFound = true;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        const uint32_t* value = index.Find(static_cast<uint64_t>(i) * 7);
+        allFound = allFound && value && *value == i;
+    }
+    TEST_ASSERT(allFound, "Every integer key should survive node growth");
+    TEST_ASSERT(index.Find(uint64_t{6}) == nullptr, "Absent integer key should not be found");
+
+    uint32_t previous = 0;
+    bool ordered = true;
+    index.ForEachWithPrefix("", [&](std::string_view, uint32_t value) {
+        ordered = ordered && (value == 0 || value == previous + 1);
+        previous = value;
+    });
+    TEST_ASSERT(ordered, "Big-endian integer keys should iterate in numeric order");
+}
+
+void TestFrozenHashMapLookup() {
+    ArenaAllocator arena(1024 * 1024);
+    FrozenHashMapBuilder<uint32_t> builder(arena);
+
+    for (uint32_t i = 0; i < 5000; ++i) {
+        builder.Add("symbol_" + std::to_string(i), i);
+    }
+    builder.Add(uint64_t{123456789}, 42u);
+
+    const FrozenHashMap<uint32_t> map = builder.Build();
+    TEST_ASSERT(map.IsValid() && map.Size() == 5001, "Frozen map should hold every added key");
+
+    bool allFound = true;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        const uint32_t* value = map.Find("symbol_" + std::to_string(i));
+        allFound = allFound && value && *value == i;
+    }
+    TEST_ASSERT(allFound, "Every key should map to its own slot");
+    TEST_ASSERT(*map.Find(uint64_t{123456789}) == 42, "Integer keys should be supported");
+    TEST_ASSERT(map.Find("symbol_5000") == nullptr && map.Find("") == nullptr,
+                "Absent keys should not be found");
+}
+
+void TestFrozenHashMapMillionsOfKeys() {
+    // A full table made the last buckets search ~n displacements each; spare slots fix that.
+    constexpr uint32_t kKeys = 2'000'000;
+    ArenaAllocator arena(256 * 1024 * 1024);
+    FrozenHashMapBuilder<uint32_t> builder(arena);
+    for (uint32_t i = 0; i < kKeys; ++i) builder.Add(uint64_t{i} * 0x9E3779B97F4A7C15ULL, i);
+
+    const auto start = std::chrono::steady_clock::now();
+    const FrozenHashMap<uint32_t> map = builder.Build();
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    bool allFound = map.Size() == kKeys;
+    for (uint32_t i = 0; allFound && i < kKeys; ++i) {
+        const uint32_t* value = map.Find(uint64_t{i} * 0x9E3779B97F4A7C15ULL);
+        allFound = value && *value == i;
+    }
+    TEST_ASSERT(allFound && !map.Find(uint64_t{1}), "Millions of keys should all be placed");
+    TEST_ASSERT(seconds.count() < 30.0, "Building millions of keys should not stall");
+}
+
+void TestFrozenHashMapSnapshot() {
+    ArenaAllocator arena(64 * 1024);
+    FrozenHashMapBuilder<double> builder(arena);
+    builder.Add("pi", 3.14);
+    builder.Add("e", 2.71);
+    const FrozenHashMap<double> built = builder.Build();
+
+    // Test Case: The block must work from any address (e.g. after mmap), since it holds no pointers.
+    ArenaAllocator other(64 * 1024);
+    void* copy = other.Alloc(built.SizeInBytes(), 64);
+    std::memcpy(copy, built.Data(), built.SizeInBytes());
+    arena.Reset();
+
+    const auto loaded = FrozenHashMap<double>::FromBytes(copy, built.SizeInBytes());
+    TEST_ASSERT(loaded.IsValid() && *loaded.Find("e") == 2.71, "Copied snapshot should be usable");
+    TEST_ASSERT(!FrozenHashMap<float>::FromBytes(copy, built.SizeInBytes()).IsValid(),
+                "Snapshot with a different value type must be rejected");
+
+    // Test Case: Corrupt or truncated snapshots must be rejected, not read out of bounds.
+    using arena_perfect_hash_detail::Header;
+    const size_t size = built.SizeInBytes();
+    auto* corrupt = static_cast<std::byte*>(other.Alloc(size + 8, 64));
+    const auto rejects = [&](auto damage, const size_t length) {
+        std::memcpy(corrupt, copy, size);
+        damage(*reinterpret_cast<Header*>(corrupt));
+        return !FrozenHashMap<double>::FromBytes(corrupt, length).IsValid();
+    };
+    TEST_ASSERT(rejects([](Header& h) { h.bucketCount = 0; }, size) &&
+                    rejects([](Header& h) { h.keyCount = h.slotCount + 1; }, size) &&
+                    rejects([](Header& h) { h.slotsOffset = h.totalSize; }, size) &&
+                    rejects([](Header& h) { h.displacementsOffset = ~uint64_t{0} - 3; }, size) &&
+                    rejects([](Header&) {}, size - 1),
+                "Corrupt snapshot headers should be rejected");
+    std::memcpy(corrupt + 4, copy, size);
+    TEST_ASSERT(!FrozenHashMap<double>::FromBytes(corrupt + 4, size).IsValid(),
+                "Misaligned snapshots should be rejected");
+
+    FrozenHashMapBuilder<int> duplicates(arena);
+    duplicates.Add("key", 1);
+    duplicates.Add("key", 2);
+    bool threw = false;
+    try {
+        (void)duplicates.Build();
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Duplicate keys should be reported");
+}
+
+void TestCsrGraphBuild() {
+    ArenaAllocator scratch(64 * 1024);
+    ArenaAllocator output(64 * 1024);
+
+    CsrGraphBuilder builder(scratch, 4);
+    builder.AddEdge(2, 0);
+    builder.AddEdge(0, 3);
+    builder.AddEdge(0, 1);
+    builder.AddUndirectedEdge(1, 2);
+
+    const size_t scratchUsed = scratch.GetUsedMemory();
+    const CsrGraph graph = builder.Build(output);
+
+    TEST_ASSERT(graph.edgeCount == 5 && graph.Degree(0) == 2 && graph.Degree(3) == 0,
+                "Offsets should encode per-node degrees");
+    TEST_ASSERT(graph.Neighbors(0)[0] == 3 && graph.Neighbors(0)[1] == 1,
+                "Neighbor lists should keep insertion order");
+    TEST_ASSERT(graph.Neighbors(2)[0] == 0 && graph.Neighbors(2)[1] == 1,
+                "Undirected edges should appear in both lists");
+    TEST_ASSERT(scratch.GetUsedMemory() == scratchUsed, "Build temporaries should be marker-scoped");
+
+    bool threw = false;
+    try {
+        builder.AddEdge(1, 4);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw && builder.GetEdgeCount() == 5, "Out-of-range node ids should be rejected");
+}
+
+void TestParallelForRethrows() {
+    ArenaAllocator scratch(64 * 1024);
+    std::atomic<int> ran{0};
+    bool caught = false;
+    try {
+        arena_parallel_detail::ParallelFor(scratch, 4, [&](const unsigned t) {
+            ++ran;
+            if (t == 2) throw std::runtime_error("worker failed");
+        });
+    } catch (const std::runtime_error& error) {
+        caught = std::string(error.what()) == "worker failed";
+    }
+    TEST_ASSERT(caught && ran.load() >= 1 && scratch.GetUsedMemory() == 0,
+                "A worker's exception should be rethrown after every thread joined");
+}
+
+void TestCsrGraphParallelMatchesSerial() {
+    ArenaAllocator scratch(4 * 1024 * 1024);
+    ArenaAllocator output(4 * 1024 * 1024);
+
+    constexpr uint32_t nodes = 1000;
+    CsrGraphBuilder builder(scratch, nodes);
+    uint32_t state = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        builder.AddEdge((state >> 8) % nodes, (state >> 16) % nodes);
+    }
+
+    const CsrGraph serial = builder.Build(output, 1);
+    const CsrGraph parallel = builder.Build(output, 4);
+
+    bool same = serial.edgeCount == parallel.edgeCount;
+    for (uint32_t v = 0; v <= nodes && same; ++v) same = serial.offsets[v] == parallel.offsets[v];
+    for (uint64_t e = 0; e < serial.edgeCount && same; ++e) {
+        same = serial.neighbors[e] == parallel.neighbors[e];
+    }
+    TEST_ASSERT(same, "Parallel build should produce the same CSR arrays as the serial build");
+}
+
+static uint64_t CountBvhOverlaps(const Bvh& bvh, const Aabb* boxes, const Aabb& query) {
+    uint64_t hits = 0;
+    bvh.ForEachOverlap(query, boxes, [&](uint32_t) { ++hits; });
+    return hits;
+}
+
+void TestBvhMatchesBruteForce() {
+    constexpr uint32_t count = 5000;
+    Aabb boxes[count];
+    uint32_t state = 99;
+    for (Aabb& box : boxes) {
+        for (int axis = 0; axis < 3; ++axis) {
+            state = state * 1664525u + 1013904223u;
+            box.min[axis] = static_cast<float>(state % 1000);
+            box.max[axis] = box.min[axis] + 5.0f;
+        }
+    }
+
+    ArenaAllocator arena(1024 * 1024);
+    BvhBuildOptions options;
+    options.threadCount = 4;
+    options.minParallelPrims = 256;
+
+    const Bvh serial = BvhBuilder::Build(arena, boxes, count);
+    const Bvh parallel = BvhBuilder::Build(arena, boxes, count, options);
+
+    bool matches = true;
+    for (uint32_t q = 0; q < count; q += 97) {
+        uint64_t expected = 0;
+        for (const Aabb& box : boxes) expected += box.Overlaps(boxes[q]) ? 1 : 0;
+        matches = matches && CountBvhOverlaps(serial, boxes, boxes[q]) == expected &&
+                  CountBvhOverlaps(parallel, boxes, boxes[q]) == expected;
+    }
+    TEST_ASSERT(matches, "BVH queries should match brute-force overlap tests");
+
+    // Test Case: The parallel build must still be laid out depth-first without gaps.
+    bool depthFirst = true;
+    for (uint32_t i = 0; i < parallel.nodeCount; ++i) {
+        const BvhNode& node = parallel.nodes[i];
+        if (!node.IsLeaf()) depthFirst = depthFirst && node.rightOrFirst > i + 1;
+        depthFirst = depthFirst && (node.IsLeaf() || node.rightOrFirst < parallel.nodeCount);
+    }
+    TEST_ASSERT(depthFirst && parallel.nodeCount <= 2 * count - 1,
+                "Parallel subtrees should be compacted into depth-first order");
+}
+
+void TestBvhDegenerateInput() {
+    // Test Case: Identical boxes give no SAH split; the builder must fall back to median splits.
+    Aabb boxes[100];
+    for (Aabb& box : boxes) {
+        box.min[0] = box.min[1] = box.min[2] = 1.0f;
+        box.max[0] = box.max[1] = box.max[2] = 2.0f;
+    }
+
+    ArenaAllocator arena(64 * 1024);
+    const Bvh bvh = BvhBuilder::Build(arena, boxes, 100);
+    TEST_ASSERT(CountBvhOverlaps(bvh, boxes, boxes[0]) == 100, "Every stacked box should be found");
+}
+
+void TestSpatialGridRadiusQuery() {
+    struct Boid {
+        float x, y, z;
+    };
+
+    constexpr uint32_t count = 2000;
+    Boid boids[count];
+    uint32_t state = 7;
+    for (Boid& boid : boids) {
+        state = state * 1664525u + 1013904223u;
+        boid.x = static_cast<float>(state % 10000) / 100.0f - 50.0f;
+        state = state * 1664525u + 1013904223u;
+        boid.y = static_cast<float>(state % 10000) / 100.0f - 50.0f;
+        boid.z = 0.0f;
+    }
+
+    ArenaAllocator frameArena(256 * 1024);
+    // Deliberately tiny table so that many cells collide in the same bucket.
+    SpatialHashGrid grid(2.0f, 16);
+    grid.Build(frameArena, boids, count);
+
+    bool matches = true;
+    for (uint32_t q = 0; q < count; q += 37) {
+        uint32_t expected = 0;
+        for (const Boid& b : boids) {
+            const float dx = b.x - boids[q].x, dy = b.y - boids[q].y;
+            expected += dx * dx + dy * dy <= 9.0f ? 1 : 0;
+        }
+
+        uint32_t found = 0;
+        grid.ForEachInRadius(boids[q].x, boids[q].y, boids[q].z, 3.0f, [&](uint32_t, float) {
+            ++found;
+        });
+        matches = matches && found == expected;
+    }
+    TEST_ASSERT(matches, "Radius queries should match brute force despite bucket collisions");
+
+    // Test Case: A rebuild after Reset reuses the same memory instead of clearing containers.
+    const size_t used = frameArena.GetUsedMemory();
+    frameArena.Reset();
+    grid.Build(frameArena, boids, count);
+    TEST_ASSERT(frameArena.GetUsedMemory() == used, "Per-frame rebuild should reuse the arena");
+}
+
+void TestArenaFormat() {
+    ArenaAllocator arena(4096);
+
+    const std::string_view line = ArenaFormat(arena, "entity {} hp={} ok={} {{tag}}", 42, 99.5, true);
+    TEST_ASSERT(line == "entity 42 hp=99.5 ok=true {tag}", "ArenaFormat should match std::format output");
+    TEST_ASSERT(line.data()[line.size()] == '\0', "Formatted text should be NUL-terminated");
+    TEST_ASSERT(arena.GetUsedMemory() == line.size() + 1, "Result should be trimmed to its length");
+
+    // Test Case: Text longer than the initial buffer grows in place at the top of the arena.
+    const std::string longName(500, 'x');
+    const std::string_view grown = ArenaFormat(arena, "name={}", longName);
+    TEST_ASSERT(grown.size() == 505 && grown.data() == line.data() + line.size() + 1,
+                "Long output should extend in place right after the previous string");
+}
+
+void TestArenaFormatOutOfMemory() {
+    ArenaAllocator arena(128);
+    const std::string tooLong(1000, 'y');
+
+    bool threw = false;
+    try {
+        (void)ArenaFormat(arena, "{}", tooLong);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+
+    TEST_ASSERT(threw && arena.GetUsedMemory() == 0, "Failed formatting should release its buffer");
+
+    // Test Case: A length whose size arithmetic would wrap fails cleanly; the text is never read.
+    ArenaStringBuilder builder(arena);
+    builder.Append("ab");
+    threw = false;
+    try {
+        builder.Append(std::string_view(tooLong.data(), SIZE_MAX / 2 + 2));
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw && arena.GetUsedMemory() == 0,
+                "An impossibly long append should throw std::bad_alloc and rewind the arena");
+}
+
+void TestSpatialGridExtremeInputs() {
+    bool threw = false;
+    try {
+        SpatialHashGrid grid(1.0f, (uint32_t{1} << 31) + 1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Bucket counts above 2^31 should be rejected instead of looping forever");
+    TEST_ASSERT(SpatialHashGrid(1.0f, uint32_t{1} << 31).GetBucketCount() == uint32_t{1} << 31,
+                "2^31 buckets is still a valid table size");
+
+    struct Point {
+        float x, y, z;
+    };
+    const Point points[] = {{1e30f, 0.0f, 0.0f}, {-1e30f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}};
+
+    ArenaAllocator arena(64 * 1024);
+    SpatialHashGrid grid(1.0f, 64);
+    grid.Build(arena, points, 3);
+
+    uint32_t far = 0;
+    grid.ForEachInCell(1e30f, 0.0f, 0.0f, [&](const uint32_t id) { far += id == 0 ? 1 : 0; });
+    uint32_t near = 0;
+    grid.ForEachInRadius(0.0f, 0.0f, 0.0f, 1.0f, [&](uint32_t, float) { ++near; });
+    TEST_ASSERT(far == 1 && near == 1,
+                "Out-of-range coordinates should clamp to an edge cell, not hit an undefined cast");
+}
+
+void TestLogSinkWritesAllRecords() {
+    const char* path = "arena_log_test.txt";
+    constexpr int threads = 4;
+    constexpr int linesPerThread = 500;
+
+    {
+        // Small buffers force many swaps between the writers and the background thread.
+        ArenaLogSink sink(path, 1024, 6);
+        const uint32_t lineFormat = sink.RegisterFormat("worker={} seq={} ratio={} name={}");
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&sink, lineFormat, t] {
+                ArenaLogSink::Writer writer = sink.CreateWriter();
+                for (int i = 0; i < linesPerThread; ++i) {
+                    writer.Log(lineFormat, t, i, 0.5, "job");
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        ArenaLogSink::Writer writer = sink.CreateWriter();
+        writer.Log(sink.RegisterFormat("{{done}} {}"), std::string(2000, 'x'));
+        TEST_ASSERT(sink.GetDroppedCount() == 1, "Records larger than a buffer should be dropped");
+    }
+
+    std::ifstream file(path);
+    std::string line;
+    int count = 0;
+    bool wellFormed = true;
+    while (std::getline(file, line)) {
+        ++count;
+        wellFormed = wellFormed && line.rfind("worker=", 0) == 0 &&
+                     line.find(" ratio=0.5 name=job") != std::string::npos;
+    }
+    std::remove(path);
+
+    TEST_ASSERT(count == threads * linesPerThread, "Every logged record should reach the file");
+    TEST_ASSERT(wellFormed, "Background thread should format records from their format ids");
+}
+
+void TestLogSinkPeriodicFlush() {
+    const char* path = "arena_log_flush_test.txt";
+    {
+        ArenaLogSink sink(path, 1024, 2, std::chrono::milliseconds(10));
+        ArenaLogSink::Writer writer = sink.CreateWriter();
+        writer.Log(sink.RegisterFormat("float={} double={}"), 0.1f, 0.1);
+
+        // The writer neither fills nor flushes its buffer; the interval alone must write it out.
+        std::string line;
+        for (int attempt = 0; attempt < 500 && line.empty(); ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::ifstream file(path);
+            std::getline(file, line);
+        }
+        TEST_ASSERT(line == "float=0.1 double=0.1",
+                    "Periodic flush should write pending records, floats at float precision");
+
+        // Records already written by the periodic flush must not be written again.
+        writer.Log(sink.RegisterFormat("second"));
+    }
+
+    std::ifstream file(path);
+    std::string line;
+    int count = 0;
+    while (std::getline(file, line)) ++count;
+    std::remove(path);
+    TEST_ASSERT(count == 2, "Each record should be written exactly once");
+}
+
+struct CountedNode {
+    int* destroyed;
+    explicit CountedNode(int* counter) : destroyed(counter) {}
+    virtual ~CountedNode() { ++*destroyed; }
+};
+
+struct DerivedNode : CountedNode {
+    using CountedNode::CountedNode;
+};
+
+void TestArenaUniqueRunsDestructor() {
+    ArenaAllocator arena(1024);
+    int destroyed = 0;
+
+    {
+        ArenaUnique<CountedNode> node = MakeArenaUnique<DerivedNode>(arena, &destroyed);
+        ArenaUnique<CountedNode> moved = std::move(node);
+        TEST_ASSERT(!node && moved, "Move should transfer ownership");
+    }
+
+    TEST_ASSERT(destroyed == 1, "ArenaUnique should run the destructor exactly once");
+    TEST_ASSERT(arena.GetUsedMemory() > 0, "Destruction should not give memory back to the arena");
+}
+
+void TestArenaSharedRefCounting() {
+    ArenaAllocator arena(1024);
+    int destroyed = 0;
+
+    ArenaShared<DerivedNode> first = MakeArenaShared<DerivedNode>(arena, &destroyed);
+    const size_t used = arena.GetUsedMemory();
+    TEST_ASSERT(used <= sizeof(DerivedNode) + 2 * alignof(std::max_align_t),
+                "Count and object should share a single allocation");
+
+    {
+        ArenaShared<CountedNode> second = first;
+        ArenaShared<CountedNode> third = second;
+        TEST_ASSERT(first.UseCount() == 3, "Copies should share one count");
+    }
+    TEST_ASSERT(destroyed == 0 && first.UseCount() == 1, "Object should live while referenced");
+
+    first.Reset();
+    TEST_ASSERT(destroyed == 1, "Last reference should run the destructor");
+    TEST_ASSERT(arena.GetUsedMemory() == used, "Memory should stay until the arena is reset");
+}
+
+void TestArenaFunctionLargeCapture() {
+    ArenaAllocator arena(4096);
+    std::array<uint64_t, 32> payload{};
+    for (size_t i = 0; i < payload.size(); ++i) payload[i] = i;
+
+    ArenaFunction<uint64_t(uint64_t)> sum(arena, [payload](const uint64_t bias) {
+        uint64_t total = bias;
+        for (const uint64_t value : payload) total += value;
+        return total;
+    });
+    TEST_ASSERT(arena.GetUsedMemory() >= sizeof(payload), "Captures should live in the arena");
+
+    ArenaFunction<uint64_t(uint64_t)> moved = std::move(sum);
+    TEST_ASSERT(!sum && moved, "Move should transfer the callable");
+    TEST_ASSERT(moved(10) == 10 + 31 * 32 / 2, "Call should reach the stored captures");
+
+    ArenaFunction<uint64_t(uint64_t)> empty;
+    TEST_ASSERT(!empty, "Default-constructed function should be empty");
+
+    int calls = 0;
+    ArenaFunction<void()> discard(arena, [&calls] { return ++calls; });
+    discard();
+    TEST_ASSERT(calls == 1, "A void signature should run a value-returning callable");
+}
+
+void TestArenaFunctionDestroysCaptures() {
+    ArenaAllocator arena(1024);
+    int destroyed = 0;
+
+    {
+        ArenaUnique<CountedNode> node = MakeArenaUnique<CountedNode>(arena, &destroyed);
+        ArenaFunction<int()> job(arena, [owned = std::move(node)] { return *owned->destroyed; });
+        ArenaFunction<int()> other;
+        other = std::move(job);
+        TEST_ASSERT(other() == 0, "Move-only captures should be callable");
+        TEST_ASSERT(destroyed == 0, "Moving the wrapper should not destroy the captures");
+    }
+    TEST_ASSERT(destroyed == 1, "Captures should be destroyed exactly once");
+
+    ArenaAllocator tiny(16);
+    bool threw = false;
+    try {
+        std::array<char, 64> big{};
+        ArenaFunction<size_t()> job(tiny, [big] { return big.size(); });
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Out of arena memory should throw std::bad_alloc");
+}
+
+// Kept out of line so it shows up as its own frame in the sampled stacks.
+[[gnu::noinline]] void AllocateForProfiler(ArenaAllocator& arena, const size_t size) {
+    TEST_ASSERT(arena.Alloc(size) != nullptr, "Profiler test arena should not run out");
+}
+
+void TestSamplingProfilerEstimates() {
+    ArenaSamplingProfiler& profiler = ArenaSamplingProfiler::Instance();
+    ArenaAllocator arena(1 << 20);
+    constexpr size_t kAllocationSize = 1000;
+    constexpr size_t kAllocationCount = 16384;
+
+    profiler.Start(4096);
+    for (size_t i = 0; i < kAllocationCount; ++i) {
+        if (arena.GetUsedMemory() + kAllocationSize > arena.GetTotalSize()) arena.Reset();
+        AllocateForProfiler(arena, kAllocationSize);
+    }
+    profiler.Stop();
+
+    double estimatedBytes = 0.0;
+    profiler.ForEachStack([&](const ArenaSamplingProfiler::StackRecord& record) {
+        estimatedBytes += record.estimatedBytes;
+    });
+    const double actualBytes = static_cast<double>(kAllocationSize * kAllocationCount);
+
+    TEST_ASSERT(profiler.GetSampleCount() > 1000, "About one sample per 4 KB should be taken");
+    TEST_ASSERT(estimatedBytes > actualBytes * 0.9 && estimatedBytes < actualBytes * 1.1,
+                "Unsampled estimate should be close to the real allocation volume");
+
+    const size_t samplesAfterStop = profiler.GetSampleCount();
+    for (size_t i = 0; i < 64; ++i) {
+        arena.Reset();
+        AllocateForProfiler(arena, 64 * 1024);
+    }
+    TEST_ASSERT(profiler.GetSampleCount() == samplesAfterStop, "Stop() should end sampling");
+
+    const char* path = "arena_profile_test.folded";
+    TEST_ASSERT(profiler.WriteFolded(path), "Folded profile should be written");
+    std::ifstream folded(path);
+    std::string line;
+    TEST_ASSERT(std::getline(folded, line) && line.find(' ') != std::string::npos,
+                "Folded lines should be 'stack bytes'");
+    folded.close();
+    std::remove(path);
+
+    // The callback runs outside the profiler's lock, so it may allocate and be sampled.
+    profiler.Start(4096);
+    arena.Reset();
+    AllocateForProfiler(arena, 64 * 1024);
+    const size_t samplesBefore = profiler.GetSampleCount();
+    profiler.ForEachStack([&](const ArenaSamplingProfiler::StackRecord&) {
+        arena.Reset();
+        AllocateForProfiler(arena, 64 * 1024);
+    });
+    profiler.Stop();
+    TEST_ASSERT(profiler.GetSampleCount() > samplesBefore,
+                "Allocating inside ForEachStack() should be sampled, not deadlock");
+}
+
+void TestHighWaterMark() {
+    ArenaAllocator arena(1024);
+    (void)arena.Alloc(600);
+    arena.Reset();
+    (void)arena.Alloc(100);
+
+    TEST_ASSERT(arena.GetUsedMemory() == 100, "Reset should rewind the offset");
+    TEST_ASSERT(arena.GetHighWaterMark() == 600, "High-water mark should survive Reset()");
+}
+
+void TestArenaRegistryJson() {
+    ArenaAllocator frame(4096);
+    (void)frame.Alloc(256);
+    const size_t before = ArenaRegistry::Instance().Size();
+
+    {
+        ArenaRegistration frameEntry(frame, "frame \"main\"");
+        ArenaAllocator level(1 << 16);
+        ArenaRegistration levelEntry(level, "level");
+        TEST_ASSERT(ArenaRegistry::Instance().Size() == before + 2, "Both arenas should register");
+
+        const std::string json = ArenaRegistry::Instance().ToJson();
+        TEST_ASSERT(json.find("\"name\":\"frame \\\"main\\\"\"") != std::string::npos,
+                    "Names should be JSON-escaped");
+        TEST_ASSERT(json.find("\"usedMemory\":256") != std::string::npos, "Usage should be listed");
+        TEST_ASSERT(json.find("\"totalSize\":65536") != std::string::npos, "Sizes should be listed");
+    }
+
+    TEST_ASSERT(ArenaRegistry::Instance().Size() == before, "Registrations should unlink on scope exit");
+}
+
+#if defined(ARENA_REGISTRY_HAS_SERVER)
+void TestIntrospectionServer() {
+    ArenaAllocator arena(2048);
+    ArenaRegistration entry(arena, "served");
+    const std::string dumpPath = "/tmp/arena_registry_test_" + std::to_string(getpid()) + ".json";
+    const std::string socketPath = "/tmp/arena_registry_test_" + std::to_string(getpid()) + ".sock";
+
+    ArenaIntrospectionOptions options;
+    options.dumpPath = dumpPath.c_str();
+    options.socketPath = socketPath.c_str();
+    ArenaIntrospectionServer server(options);
+
+    // Socket: connect and read until the server closes the connection.
+    const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath.c_str());
+    TEST_ASSERT(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0,
+                "Client should connect to the introspection socket");
+    std::string reply;
+    char buffer[256];
+    ssize_t received;
+    while ((received = read(client, buffer, sizeof(buffer))) > 0) {
+        reply.append(buffer, static_cast<size_t>(received));
+    }
+    close(client);
+    TEST_ASSERT(reply.find("\"name\":\"served\"") != std::string::npos, "Socket should serve JSON");
+
+    // Signal: the handler only wakes the server thread, so wait for the file to appear.
+    std::raise(SIGUSR1);
+    for (int i = 0; i < 200 && server.GetDumpCount() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::ifstream dump(dumpPath);
+    std::string line;
+    TEST_ASSERT(std::getline(dump, line) && line.find("\"served\"") != std::string::npos,
+                "SIGUSR1 should dump the registry to the file");
+    std::remove(dumpPath.c_str());
+}
+
+int ConnectToServer(const std::string& socketPath) {
+    const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath.c_str());
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(client);
+        return -1;
+    }
+    return client;
+}
+
+void TestIntrospectionServerDropsSlowClients() {
+    // Enough arenas that the JSON (~1 MB) cannot sit in a socket buffer for a client not reading.
+    std::deque<ArenaAllocator> arenas;
+    std::deque<ArenaRegistration> entries;
+    const std::string padding(ArenaRegistration::kMaxNameLength - 8, 'x');
+    for (int i = 0; i < 6000; ++i) {
+        arenas.emplace_back(64);
+        entries.emplace_back(arenas.back(), padding + std::to_string(i));
+    }
+    const std::string socketPath = "/tmp/arena_registry_slow_" + std::to_string(getpid()) + ".sock";
+
+    ArenaIntrospectionOptions options;
+    options.socketPath = socketPath.c_str();
+    {
+        ArenaIntrospectionServer server(options);
+        const int stalled = ConnectToServer(socketPath); // Connects and never reads
+        const int reader = ConnectToServer(socketPath);
+        TEST_ASSERT(stalled >= 0 && reader >= 0, "Both clients should connect");
+
+        timeval timeout{5, 0}; // Fail rather than hang if the server is stuck on `stalled`
+        setsockopt(reader, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string reply;
+        char buffer[4096];
+        ssize_t received;
+        while ((received = read(reader, buffer, sizeof(buffer))) > 0) {
+            reply.append(buffer, static_cast<size_t>(received));
+        }
+        close(reader);
+        TEST_ASSERT(reply.size() > 512 * 1024 && reply.ends_with("]}\n"),
+                    "A client that never reads should not hold up the next one");
+        close(stalled);
+    }
+
+    // Only a socket at the path is taken for a stale one; a regular file there is left alone.
+    {
+        std::ofstream(socketPath) << "keep me";
+    }
+    bool threw = false;
+    try {
+        ArenaIntrospectionServer server(options);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    std::ifstream kept(socketPath);
+    std::string content;
+    TEST_ASSERT(threw && std::getline(kept, content) && content == "keep me",
+                "The server should refuse, not delete, a non-socket file at its socket path");
+    std::remove(socketPath.c_str());
+}
+#endif
+
+void TestOccupancyRecorderLayout() {
+    ArenaAllocator arena(4096);
+    ArenaOccupancyRecorder recorder(arena);
+
+    (void)arena.Alloc(3, 1);
+    {
+        ArenaOccupancyTag tag("physics");
+        (void)arena.Alloc(16, 16);
+    }
+    const ArenaAllocator::Marker marker = arena.GetMarker();
+    (void)arena.Alloc(100, 8);
+    arena.ResetToMarker(marker);
+
+    const ArenaOccupancyMap map = recorder.Snapshot();
+    TEST_ASSERT(map.allocations.size() == 2, "Rewind should drop allocations above the marker");
+    const ArenaOccupancyMap::Allocation& aligned = map.allocations[1];
+    TEST_ASSERT(aligned.offset % 16 == 0 && aligned.padding == aligned.offset - 3,
+                "Padding should cover the gap up to the aligned offset");
+    TEST_ASSERT(map.tags[aligned.tag] == "physics" && map.allocations[0].tag == 0,
+                "Allocations should carry the tag in scope");
+
+    const char* path = "arena_occupancy_test.bin";
+    recorder.WriteFile(path);
+    const ArenaOccupancyMap loaded = ArenaOccupancyMap::Load(path);
+
+    // Test Case: A corrupt allocation count is rejected before anything is allocated for it.
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const uint64_t hugeCount = uint64_t{1} << 60;
+        file.seekp(32); // FileHeader::allocationCount
+        file.write(reinterpret_cast<const char*>(&hugeCount), sizeof(hugeCount));
+    }
+    bool rejected = false;
+    try {
+        (void)ArenaOccupancyMap::Load(path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    std::remove(path);
+    TEST_ASSERT(rejected, "A count larger than the file should fail as an invalid file");
+    TEST_ASSERT(loaded.totalSize == 4096 && loaded.usedMemory == map.usedMemory,
+                "Totals should round-trip through the file");
+    TEST_ASSERT(loaded.allocations.size() == 2 && loaded.allocations[1].padding == aligned.padding &&
+                    loaded.tags == map.tags,
+                "Allocations and tags should round-trip through the file");
+}
+
+void TestArenaMemoryResource() {
+    ArenaAllocator arena(4096);
+    ArenaMemoryResource resource(arena);
+
+    std::pmr::vector<int> values(&resource);
+    for (int i = 0; i < 100; ++i) values.push_back(i);
+    TEST_ASSERT(values[99] == 99 && arena.GetUsedMemory() >= 100 * sizeof(int),
+                "pmr containers should allocate from the arena");
+
+    bool threw = false;
+    try {
+        values.reserve(4096);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "A full arena should throw std::bad_alloc instead of using the heap");
+}
+
+void TestBloomFilterPerBatch() {
+    ArenaAllocator arena(1024 * 1024);
+    const ArenaAllocator::Marker batchStart = arena.GetMarker();
+    constexpr uint64_t kKeys = 10000;
+
+    ArenaBloomFilter filter(arena, kKeys);
+    for (uint64_t key = 0; key < kKeys; ++key) filter.Insert(key * 7919);
+
+    bool allFound = true;
+    for (uint64_t key = 0; key < kKeys; ++key) allFound &= filter.MayContain(key * 7919);
+    TEST_ASSERT(allFound, "Bloom filter should have no false negatives");
+
+    size_t falsePositives = 0;
+    for (uint64_t key = kKeys; key < 2 * kKeys; ++key) {
+        falsePositives += filter.MayContain(key * 7919);
+    }
+    TEST_ASSERT(falsePositives < kKeys / 30, "Bloom false positive rate should be a few percent");
+    TEST_ASSERT(filter.GetMemoryBytes() * 8 >= kKeys * 10,
+                "Bloom filter should be sized from the expected count");
+
+    arena.ResetToMarker(batchStart);
+    TEST_ASSERT(arena.GetUsedMemory() == 0, "Rewinding the batch should drop the filter");
+}
+
+void TestCuckooFilterErase() {
+    ArenaAllocator arena(1024 * 1024);
+    constexpr uint64_t kKeys = 10000;
+
+    ArenaCuckooFilter filter(arena, kKeys);
+    bool inserted = true;
+    for (uint64_t key = 0; key < kKeys; ++key) inserted &= filter.Insert(key);
+    TEST_ASSERT(inserted && filter.Size() == kKeys, "Cuckoo filter should hold its expected count");
+
+    bool allFound = true;
+    for (uint64_t key = 0; key < kKeys; ++key) allFound &= filter.MayContain(key);
+    TEST_ASSERT(allFound, "Cuckoo filter should have no false negatives");
+
+    size_t falsePositives = 0;
+    for (uint64_t key = kKeys; key < 2 * kKeys; ++key) falsePositives += filter.MayContain(key);
+    TEST_ASSERT(falsePositives < 20, "Cuckoo false positive rate should be well under 1%");
+
+    for (uint64_t key = 0; key < kKeys; key += 2) filter.Erase(key);
+    size_t stillFound = 0;
+    for (uint64_t key = 0; key < kKeys; key += 2) stillFound += filter.MayContain(key);
+    bool oddsKept = true;
+    for (uint64_t key = 1; key < kKeys; key += 2) oddsKept &= filter.MayContain(key);
+    TEST_ASSERT(stillFound < 20 && oddsKept && filter.Size() == kKeys / 2,
+                "Erase should remove only the erased keys");
+}
+
+void TestSparseSetAddRemove() {
+    ArenaAllocator arena(1024 * 1024);
+    ArenaSparseSet<std::string> names(arena);
+
+    for (uint32_t entity = 0; entity < 100; ++entity) {
+        names.Insert(entity * 3, "entity" + std::to_string(entity * 3));
+    }
+    TEST_ASSERT(names.Size() == 100 && *names.Find(297) == "entity297" && !names.Find(298),
+                "Sparse set lookup should find inserted entities only");
+
+    bool threw = false;
+    try {
+        names.Insert(3, "again");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Inserting an entity twice should throw");
+
+    for (uint32_t entity = 0; entity < 300; entity += 6) names.Remove(entity);
+    bool consistent = names.Size() == 50;
+    names.ForEach([&](const uint32_t entity, const std::string& name) {
+        consistent &= entity % 6 == 3 && name == "entity" + std::to_string(entity);
+    });
+    TEST_ASSERT(consistent && !names.Remove(0), "Remove should keep dense arrays packed");
+
+    names.Clear();
+    TEST_ASSERT(names.IsEmpty() && !names.Contains(3), "Clear should remove every entity");
+
+    // Test Case: Copying a component of the set while the insert grows the dense arrays.
+    ArenaSparseSet<std::string> copies(arena);
+    const std::string longName(40, 'n'); // Heap-allocated, so a dangling source is visible
+    for (uint32_t entity = 0; entity < 16; ++entity) copies.Insert(entity, longName);
+    const std::string& source = *copies.Find(0);
+    TEST_ASSERT(copies.Insert(16, source) == longName && *copies.Find(0) == longName,
+                "Insert should copy its argument before growing the dense arrays");
+}
+
+void TestSparseSetLazyPages() {
+    ArenaAllocator arena(1024 * 1024);
+    ArenaSparseSet<float> health(arena);
+
+    health.Insert(7, 1.0f);
+    health.Insert(4'000'000'000u, 2.0f);
+    health.Insert(4'000'000'001u, 3.0f);
+    TEST_ASSERT(health.GetPageCount() == 2 && arena.GetUsedMemory() < 64 * 1024,
+                "Only pages holding ids should be allocated");
+    TEST_ASSERT(*health.Find(4'000'000'001u) == 3.0f && !health.Contains(8'000'000u),
+                "Lookups should work across distant pages");
+}
+
+void TestStringTableCompare() {
+    ArenaAllocator arena(64 * 1024);
+    ArenaStringTable table(arena);
+    const std::string longText(40, 'x');
+
+    table.Append("apple");
+    table.Append("");
+    table.Append(longText + "a");
+    table.Append(longText + "b");
+    table.Append("apple");
+
+    TEST_ASSERT(table.Size() == 5 && table.Get(0) == "apple" && table.Get(1).empty() &&
+                    table.GetByteSize() == 92,
+                "String table should store strings back to back");
+    TEST_ASSERT(table.Equals(0, 4) && !table.Equals(2, 3) && table.Equals(3, longText + "b"),
+                "String table equality should compare full contents");
+    TEST_ASSERT(table.StartsWith(3, longText) && !table.StartsWith(0, "apples") &&
+                    table.StartsWith(1, ""),
+                "String table prefix checks should match std::string_view");
+    TEST_ASSERT(table.Compare(2, 3) < 0 && table.Compare(3, 2) > 0 && table.Compare(0, 4) == 0,
+                "String table compare should find mismatches past 16 bytes");
+}
+
+void TestStringTableSortMatchesStdSort() {
+    ArenaAllocator arena(16 * 1024 * 1024);
+    ArenaStringTable table(arena);
+    std::vector<std::string> expected;
+
+    // Many shared prefixes and duplicates, plus bytes above 0x7F to check unsigned ordering.
+    uint32_t state = 12345;
+    for (int i = 0; i < 20000; ++i) {
+        state = state * 1103515245u + 12345u;
+        std::string text = "key/" + std::to_string((state >> 8) % 3000);
+        if (state & 1) text += std::string(1 + (state >> 4) % 90, static_cast<char>(0xC3));
+        table.Append(text);
+        expected.push_back(text);
+    }
+    std::stable_sort(expected.begin(), expected.end());
+
+    for (const unsigned threads : {1u, 4u}) {
+        std::vector<uint32_t> order(table.Size());
+        const size_t used = arena.GetUsedMemory();
+        table.Sort(order.data(), arena, threads);
+
+        bool sorted = arena.GetUsedMemory() == used;
+        for (size_t i = 0; i < order.size(); ++i) sorted &= table.Get(order[i]) == expected[i];
+        for (size_t i = 1; i < order.size(); ++i) {
+            if (table.Equals(order[i - 1], order[i])) sorted &= order[i - 1] < order[i];
+        }
+        TEST_ASSERT(sorted, "Radix sort should match std::stable_sort and release its scratch");
+    }
+}
+
+void TestRecordBatchColumns() {
+    ArenaAllocator arena(1024 * 1024);
+    const ArenaAllocator::Marker batchStart = arena.GetMarker();
+    constexpr uint32_t kRows = 1000;
+    const ColumnSchema schema[] = {{"id", ColumnType::Int64},
+                                   {"price", ColumnType::Float64, true},
+                                   {"name", ColumnType::String, true}};
+
+    ArenaRecordBatch batch(arena, schema, kRows);
+    auto* ids = batch.Values<int64_t>(0);
+    auto* prices = batch.Values<double>(1);
+    for (uint32_t row = 0; row < kRows; ++row) {
+        ids[row] = row;
+        prices[row] = 2.0;
+        if (row % 7 == 0) {
+            batch.SetNull(1, row);
+            batch.SetNull(2, row);
+            batch.Strings(2).Append("");
+        } else {
+            batch.Strings(2).Append("item" + std::to_string(row));
+        }
+    }
+    batch.SetRowCount(kRows);
+
+    TEST_ASSERT(reinterpret_cast<uintptr_t>(ids) % 64 == 0 &&
+                    reinterpret_cast<uintptr_t>(batch.Validity(1)) % 64 == 0,
+                "Record batch columns should be 64-byte aligned");
+    TEST_ASSERT(batch.CountNulls(1) == 143 && batch.CountNulls(0) == 0 && !batch.IsValid(2, 14) &&
+                    batch.Strings(2).Get(15) == "item15",
+                "Validity bitmaps should track null rows");
+
+    // Branch-free masked sum: the shape of loop a compiler can vectorize.
+    const uint64_t* validity = batch.Validity(1);
+    double total = 0.0;
+    for (uint32_t row = 0; row < batch.RowCount(); ++row) {
+        total += prices[row] * static_cast<double>((validity[row / 64] >> (row % 64)) & 1);
+    }
+    TEST_ASSERT(total == 2.0 * (kRows - 143) && batch.FindColumn("name") == 2,
+                "Column scans should skip null rows");
+
+    bool typeChecked = false;
+    try {
+        (void)batch.Values<float>(1);
+    } catch (const std::invalid_argument&) {
+        typeChecked = true;
+    }
+    bool countChecked = false;
+    try {
+        batch.SetRowCount(kRows - 1);
+    } catch (const std::invalid_argument&) {
+        countChecked = true;
+    }
+    TEST_ASSERT(typeChecked && countChecked, "Record batch should reject mismatched access");
+
+    arena.ResetToMarker(batchStart);
+    TEST_ASSERT(arena.GetUsedMemory() == 0, "One rewind should release the whole batch");
+}
+
+void TestHashJoinMatchesNestedLoop() {
+    ArenaAllocator output(4 * 1024 * 1024);
+    ArenaAllocator scratch(4 * 1024 * 1024);
+    ArenaAllocator worker1(1024 * 1024);
+    ArenaAllocator worker2(1024 * 1024);
+    ArenaAllocator worker3(1024 * 1024);
+
+    // Duplicate keys on both sides, keys above 2^32, and probe keys with no partner.
+    std::vector<uint64_t> build;
+    std::vector<uint64_t> probe;
+    for (uint64_t i = 0; i < 20000; ++i) build.push_back((i % 15000) * 0x100000001ULL);
+    for (uint64_t i = 0; i < 30000; ++i) probe.push_back((i * 7 % 20000) * 0x100000001ULL);
+
+    std::multimap<uint64_t, uint32_t> buildRows;
+    for (uint32_t row = 0; row < build.size(); ++row) buildRows.emplace(build[row], row);
+    std::vector<std::pair<uint32_t, uint32_t>> expected;
+    for (uint32_t row = 0; row < probe.size(); ++row) {
+        const auto [begin, end] = buildRows.equal_range(probe[row]);
+        for (auto it = begin; it != end; ++it) expected.emplace_back(it->second, row);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    const auto sortedPairs = [](const JoinResult& result) {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (size_t i = 0; i < result.count; ++i) {
+            pairs.emplace_back(result.matches[i].buildRow, result.matches[i].probeRow);
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    };
+
+    const JoinResult serial =
+        ArenaHashKernels::HashJoin(build, probe, output, scratch, HashKernelOptions{3});
+    TEST_ASSERT(sortedPairs(serial) == expected && scratch.GetUsedMemory() == 0,
+                "Hash join should match a nested-loop join and rewind its scratch");
+
+    ArenaAllocator* threads[] = {&worker1, &worker2, &worker3};
+    const JoinResult parallel = ArenaHashKernels::ParallelHashJoin(build, probe, output, scratch,
+                                                                   threads, HashKernelOptions{3});
+    TEST_ASSERT(sortedPairs(parallel) == expected && worker1.GetUsedMemory() == 0 &&
+                    worker3.GetUsedMemory() == 0,
+                "Parallel hash join should match and rewind the thread arenas");
+
+    uint32_t hashes[7];
+    HashKeys(probe.data(), 7, hashes);
+    bool sameHashes = true;
+    for (int i = 0; i < 7; ++i) {
+        sameHashes &= hashes[i] == arena_hash_kernels_detail::HashKey(probe[i]);
+    }
+    TEST_ASSERT(sameHashes, "SIMD key hashing should match the scalar hash");
+
+    bool threw = false;
+    try {
+        (void)ArenaHashKernels::HashJoin(build, probe, scratch, scratch);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "Hash join should refuse to put its output in the scratch arena");
+}
+
+void TestHashGroupByMatchesMap() {
+    ArenaAllocator output(4 * 1024 * 1024);
+    ArenaAllocator scratch(4 * 1024 * 1024);
+    ArenaAllocator worker1(1024 * 1024);
+    ArenaAllocator worker2(1024 * 1024);
+
+    std::vector<uint64_t> keys;
+    std::vector<int64_t> values;
+    std::map<uint64_t, std::pair<uint32_t, int64_t>> expected;
+    uint32_t state = 99;
+    for (int i = 0; i < 50000; ++i) {
+        state = state * 1103515245u + 12345u;
+        keys.push_back((state >> 8) % 5000);
+        values.push_back(static_cast<int64_t>(state % 100) - 50);
+        auto& group = expected[keys.back()];
+        ++group.first;
+        group.second += values.back();
+    }
+
+    const auto matches = [&](const GroupByResult& result) {
+        bool same = result.groupCount == expected.size();
+        for (size_t g = 0; same && g < result.groupCount; ++g) {
+            const auto it = expected.find(result.keys[g]);
+            same = it != expected.end() && it->second.first == result.counts[g] &&
+                   it->second.second == result.sums[g];
+        }
+        return same;
+    };
+
+    const GroupByResult serial = ArenaHashKernels::HashGroupBy(keys, values, output, scratch);
+    ArenaAllocator* threads[] = {&worker1, &worker2};
+    const GroupByResult parallel = ArenaHashKernels::ParallelHashGroupBy(
+        keys, values, output, scratch, threads, HashKernelOptions{4});
+    TEST_ASSERT(matches(serial) && matches(parallel) && scratch.GetUsedMemory() == 0,
+                "Hash group-by should match std::map counts and sums");
+
+    const GroupByResult countsOnly = ArenaHashKernels::HashGroupBy(keys, {}, output, scratch);
+    TEST_ASSERT(countsOnly.groupCount == expected.size() && !countsOnly.sums,
+                "Group-by without values should only count");
+}
+
+void TestExternalSortSpillsAndMerges() {
+    ArenaAllocator arena(256 * 1024);
+    (void)arena.Alloc(100);
+    const size_t before = arena.GetUsedMemory();
+
+    std::vector<uint64_t> values;
+    uint64_t state = 7;
+    for (int i = 0; i < 200000; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        values.push_back(state >> 40); // Plenty of duplicates
+    }
+    std::vector<uint64_t> expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<uint64_t> sorted;
+    {
+        // About 7 runs of 32K records, more than the arena has read buffers for at once.
+        ArenaExternalSorter<uint64_t> sorter(arena);
+        sorter.Push(std::span<const uint64_t>(values.data(), 1000));
+        for (size_t i = 1000; i < values.size(); ++i) sorter.Push(values[i]);
+        sorter.Finish([&](const uint64_t value) { sorted.push_back(value); });
+        TEST_ASSERT(sorted == expected && sorter.GetRunCount() > 3,
+                    "External sort should spill runs and merge them in order");
+
+        // A sorter is reusable, and small input never touches the disk.
+        const uint64_t spilled = sorter.GetSpilledBytes();
+        sorted.clear();
+        for (const uint64_t value : {5, 3, 9}) sorter.Push(value);
+        sorter.Finish([&](const uint64_t value) { sorted.push_back(value); });
+        TEST_ASSERT((sorted == std::vector<uint64_t>{3, 5, 9}) &&
+                        sorter.GetSpilledBytes() == spilled,
+                    "Input that fits in one run should be sorted in memory");
+
+        // Test Case: A throwing sink mid-merge leaves the sorter empty, not pointing at the
+        // runs and arena space of the abandoned merge.
+        sorter.Push(std::span<const uint64_t>(values.data(), values.size()));
+        size_t delivered = 0;
+        try {
+            sorter.Finish([&](uint64_t) {
+                if (++delivered == 10) throw std::runtime_error("sink failed");
+            });
+        } catch (const std::runtime_error&) {
+        }
+        sorted.clear();
+        for (const uint64_t value : {8, 1}) sorter.Push(value);
+        sorter.Finish([&](const uint64_t value) { sorted.push_back(value); });
+        TEST_ASSERT(delivered == 10 && (sorted == std::vector<uint64_t>{1, 8}),
+                    "A sorter whose sink threw should be reusable with only the new input");
+    }
+    TEST_ASSERT(arena.GetUsedMemory() == before, "The sorter should rewind the arena it claimed");
+
+    ArenaAllocator tiny(1024);
+    bool threw = false;
+    try {
+        ArenaExternalSorter<uint64_t> sorter(tiny);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TEST_ASSERT(threw, "An arena too small for a run should be rejected");
+    TEST_ASSERT(tiny.GetUsedMemory() == 0, "A rejected sorter should leave its arena unclaimed");
+}
+
+void TestMemoCacheInvalidatesOnReset() {
+    ArenaAllocator frame(64 * 1024);
+    ArenaAllocator persistent(64 * 1024);
+    ArenaMemoCache<uint32_t, uint64_t> cache(frame, persistent, 16);
+
+    int computed = 0;
+    std::function<uint64_t(uint32_t)> fib = [&](const uint32_t n) -> uint64_t {
+        ++computed;
+        if (n < 2) return n;
+        return cache.GetOrCompute(n - 1, fib) + cache.GetOrCompute(n - 2, fib);
+    };
+    TEST_ASSERT(cache.GetOrCompute(80, fib) == 23416728348467685ULL && computed == 81,
+                "Recursive computations should be memoized across table growth");
+    TEST_ASSERT(cache.GetCapacity() > 16 && cache.Find(40) && *cache.Find(40) == 102334155,
+                "Entries should survive growth");
+
+    frame.Reset();
+    TEST_ASSERT(!cache.Find(40) && cache.Size() == 0, "Reset of the frame arena should empty it");
+    cache.Put(7, 1);
+    (void)frame.Alloc(1024); // Other frame allocations
+    TEST_ASSERT(cache.Find(7) && *cache.Find(7) == 1, "The cache should fill again after a reset");
+
+    const ArenaAllocator::Marker marker = frame.GetMarker();
+    cache.Put(8, 2);
+    frame.ResetToMarker(marker);
+    TEST_ASSERT(!cache.Find(7) && !cache.Find(8), "A rewind below the entries should empty it");
+
+    cache.Put(9, 3);
+    cache.Invalidate();
+    TEST_ASSERT(!cache.Find(9) && cache.GetHitCount() > 0, "Invalidate() should empty it");
+}
+
 int main() {
     std::cout << "Running Unit Tests...\n";
 
@@ -91,6 +1591,56 @@ int main() {
     TestReset();
     TestArrayAllocation();
     TestNoDestructorCallOnReset();
+    TestTryExtend();
+    TestSmallVectorInline();
+    TestSmallVectorSpill();
+    TestSmallVectorPushBackOwnElement();
+    TestDequeFifoOrder();
+    TestDequeSegmentRecycling();
+    TestDequeThrowingConstructor();
+    TestArenaScopeRewinds();
+    TestIndexedHeapDecreaseKey();
+    TestPathQueryDijkstra();
+    TestRadixTreeStringKeys();
+    TestRadixTreeNodeGrowth();
+    TestFrozenHashMapLookup();
+    TestFrozenHashMapSnapshot();
+    TestFrozenHashMapMillionsOfKeys();
+    TestCsrGraphBuild();
+    TestCsrGraphParallelMatchesSerial();
+    TestParallelForRethrows();
+    TestBvhMatchesBruteForce();
+    TestBvhDegenerateInput();
+    TestSpatialGridRadiusQuery();
+    TestSpatialGridExtremeInputs();
+    TestArenaFormat();
+    TestArenaFormatOutOfMemory();
+    TestLogSinkWritesAllRecords();
+    TestLogSinkPeriodicFlush();
+    TestArenaUniqueRunsDestructor();
+    TestArenaSharedRefCounting();
+    TestArenaFunctionLargeCapture();
+    TestArenaFunctionDestroysCaptures();
+    TestSamplingProfilerEstimates();
+    TestHighWaterMark();
+    TestArenaRegistryJson();
+#if defined(ARENA_REGISTRY_HAS_SERVER)
+    TestIntrospectionServer();
+    TestIntrospectionServerDropsSlowClients();
+#endif
+    TestOccupancyRecorderLayout();
+    TestArenaMemoryResource();
+    TestBloomFilterPerBatch();
+    TestCuckooFilterErase();
+    TestSparseSetAddRemove();
+    TestSparseSetLazyPages();
+    TestStringTableCompare();
+    TestStringTableSortMatchesStdSort();
+    TestRecordBatchColumns();
+    TestHashJoinMatchesNestedLoop();
+    TestHashGroupByMatchesMap();
+    TestExternalSortSpillsAndMerges();
+    TestMemoCacheInvalidatesOnReset();
 
     std::cout << "All Tests Passed!\n";
     return 0;
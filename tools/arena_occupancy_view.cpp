@@ -0,0 +1,140 @@
+// Offline viewer for ArenaOccupancyMap files (written by ArenaOccupancyRecorder::WriteFile).
+//
+//   arena_occupancy_view <file> [--width N] [--rows N] [--used]
+//
+// Prints waste summaries by alignment class and by tag, then an ASCII heatmap of the arena:
+// one character per cell, darker meaning a larger share of the cell holds payload.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "arena_occupancy.h"
+
+struct WasteStats {
+    uint64_t count = 0;
+    uint64_t payload = 0;
+    uint64_t padding = 0;
+};
+
+void PrintWasteTable(const char* title, const std::map<std::string, WasteStats>& rows) {
+    std::cout << "\n" << std::left << std::setw(20) << title << std::right << std::setw(10)
+              << "allocs" << std::setw(14) << "payload" << std::setw(12) << "padding"
+              << std::setw(10) << "waste\n";
+    for (const auto& [name, stats] : rows) {
+        const uint64_t total = stats.payload + stats.padding;
+        const double waste = total ? 100.0 * static_cast<double>(stats.padding) / total : 0.0;
+        std::cout << std::left << std::setw(20) << name << std::right << std::setw(10)
+                  << stats.count << std::setw(14) << stats.payload << std::setw(12)
+                  << stats.padding << std::setw(8) << std::fixed << std::setprecision(1) << waste
+                  << " %\n";
+    }
+}
+
+// Adds the part of [begin, end) that falls in each cell to cells[].
+void Accumulate(std::vector<double>& cells, const uint64_t cellBytes, const uint64_t begin,
+                const uint64_t end) {
+    for (uint64_t position = begin; position < end;) {
+        const uint64_t cell = position / cellBytes;
+        if (cell >= cells.size()) return;
+        const uint64_t cellEnd = std::min(end, (cell + 1) * cellBytes);
+        cells[cell] += static_cast<double>(cellEnd - position);
+        position = cellEnd;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <file> [--width N] [--rows N] [--used]\n";
+        return 2;
+    }
+
+    uint64_t width = 64;
+    uint64_t rows = 16;
+    bool usedOnly = false;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            width = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            rows = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--used") == 0) {
+            usedOnly = true;
+        }
+    }
+
+    ArenaOccupancyMap map;
+    try {
+        map = ArenaOccupancyMap::Load(argv[1]);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+
+    std::map<std::string, WasteStats> byAlign;
+    std::map<std::string, WasteStats> byTag;
+    uint64_t payload = 0;
+    uint64_t padding = 0;
+    for (const ArenaOccupancyMap::Allocation& allocation : map.allocations) {
+        payload += allocation.size;
+        padding += allocation.padding;
+
+        // Space-padded to a fixed width so the std::map orders alignment classes numerically.
+        char alignName[32];
+        std::snprintf(alignName, sizeof(alignName), "align %6u", allocation.align);
+        const std::string tagName =
+            allocation.tag < map.tags.size() ? map.tags[allocation.tag] : "?";
+
+        for (WasteStats* stats : {&byAlign[alignName], &byTag[tagName]}) {
+            ++stats->count;
+            stats->payload += allocation.size;
+            stats->padding += allocation.padding;
+        }
+    }
+
+    std::cout << "Arena size : " << map.totalSize << " bytes\n";
+    std::cout << "Used       : " << map.usedMemory << " bytes in " << map.allocations.size()
+              << " allocations\n";
+    std::cout << "Payload    : " << payload << " bytes\n";
+    std::cout << "Padding    : " << padding << " bytes ("
+              << std::fixed << std::setprecision(2)
+              << (map.usedMemory ? 100.0 * static_cast<double>(padding) / map.usedMemory : 0.0)
+              << " % of used)\n";
+    PrintWasteTable("Alignment class", byAlign);
+    PrintWasteTable("Tag", byTag);
+
+    // Heatmap over the whole arena (or only the used prefix with --used).
+    const uint64_t span = usedOnly ? map.usedMemory : map.totalSize;
+    if (span == 0) return 0;
+    const uint64_t cellBytes = std::max<uint64_t>(1, (span + width * rows - 1) / (width * rows));
+    const uint64_t cellCount = (span + cellBytes - 1) / cellBytes;
+
+    std::vector<double> cells(cellCount, 0.0);
+    for (const ArenaOccupancyMap::Allocation& allocation : map.allocations) {
+        Accumulate(cells, cellBytes, allocation.offset, allocation.offset + allocation.size);
+    }
+
+    // Cells past the end of the used region are blank; inside it, '.' is padding or gaps only.
+    static constexpr char kRamp[] = ".:-=+*#%@";
+    constexpr int kLevels = sizeof(kRamp) - 2;
+    std::cout << "\nMap: " << cellBytes << " bytes per cell ('.' = no payload ... '@' = full)\n";
+    for (uint64_t cell = 0; cell < cellCount; ++cell) {
+        const uint64_t cellStart = cell * cellBytes;
+        char symbol = ' ';
+        if (cellStart < map.usedMemory) {
+            const uint64_t cellSize = std::min(cellBytes, span - cellStart);
+            const double fill = cells[cell] / static_cast<double>(cellSize);
+            symbol = kRamp[static_cast<int>(std::min(1.0, fill) * kLevels + 0.5)];
+        }
+        std::cout << symbol;
+        if ((cell + 1) % width == 0 || cell + 1 == cellCount) std::cout << '\n';
+    }
+
+    return 0;
+}